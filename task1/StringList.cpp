@@ -1,8 +1,131 @@
 #include "StringList.hpp"
+#include "StringListDetail.hpp"
 #include <cstring>
 
+namespace {
+    /// @brief Grows an array of the list, copying it out of the file mapping if the list does not own it.
+    void* growArray(char* const* list, void* array, size_t usedBytes, size_t newBytes) {
+        if (StringListOwns(list, array)) return realloc(array, newBytes);
+
+        auto copy = malloc(newBytes);
+        memcpy(copy, array, usedBytes);
+        return copy;
+    }
+
+    /// @brief Makes sure the list can hold at least the given number of strings, growing geometrically.
+    void reserve(char*** list, size_t needed) {
+        auto header = StringListHeader(*list);
+        size_t capacity = header[STRING_LIST_CAPACITY];
+        if (needed <= capacity) return;
+
+        size_t size = header[STRING_LIST_SIZE];
+        auto lengths = StringListLengths(*list);
+        auto prefixes = StringListPrefixes(*list);
+        capacity = capacity * 2 > needed ? capacity * 2 : needed;
+        lengths = static_cast<size_t*>(growArray(*list, lengths, sizeof(size_t) * size, sizeof(size_t) * capacity));
+        prefixes = static_cast<size_t*>(growArray(*list, prefixes, sizeof(size_t) * size, sizeof(size_t) * capacity));
+        header = static_cast<size_t*>(growArray(
+            *list, header,
+            sizeof(size_t) * STRING_LIST_HEADER_WORDS + sizeof(char*) * (size + 1),
+            sizeof(size_t) * STRING_LIST_HEADER_WORDS + sizeof(char*) * (capacity + 1)
+        ));
+
+        header[STRING_LIST_CAPACITY] = capacity;
+        header[STRING_LIST_LENGTHS] = reinterpret_cast<size_t>(lengths);
+        header[STRING_LIST_PREFIXES] = reinterpret_cast<size_t>(prefixes);
+        *list = reinterpret_cast<char**>(header + STRING_LIST_HEADER_WORDS);
+    }
+
+    /// @brief Frees a string of the list, unless it lives in the list's file mapping.
+    void releaseString(char* const* list, char* str) {
+        if (StringListOwns(list, str)) free(str);
+    }
+
+    /// @brief Updates the size of the list and its null terminator.
+    void setSize(char** list, size_t size) {
+        StringListHeader(list)[STRING_LIST_SIZE] = size;
+        list[size] = nullptr;
+    }
+
+    /// @brief Stores a string and its cached length and prefix at the given index.
+    void setEntry(char** list, size_t index, char* str, size_t len) {
+        list[index] = str;
+        StringListLengths(list)[index] = len;
+        StringListPrefixes(list)[index] = StringListPrefixOf(str, len);
+    }
+
+    /// @brief Moves an entry to a lower index, overwriting what was there.
+    void moveEntry(char** list, size_t from, size_t to) {
+        list[to] = list[from];
+        StringListLengths(list)[to] = StringListLengths(list)[from];
+        StringListPrefixes(list)[to] = StringListPrefixes(list)[from];
+    }
+
+    char* copyString(char const* str, size_t len) {
+        auto copy = static_cast<char*>(malloc(len + 1));
+        memcpy(copy, str, len);
+        copy[len] = '\0';
+        return copy;
+    }
+
+    /// @brief Clears the sorted flag if the entries from the given index on break the order.
+    void checkAppendedOrder(char** list, size_t from) {
+        if (!StringListIsSorted(list)) return;
+        for (size_t i = from ? from : 1, size = StringListSize(list); i < size; ++i) {
+            if (StringListCompareEntries(list, i - 1, i) > 0) {
+                StringListSetSorted(list, false);
+                return;
+            }
+        }
+    }
+
+    /// @brief Binary search for the first entry that is not less than (or, if upper, greater than) the string.
+    size_t searchSorted(char* const* list, char const* str, size_t len, size_t prefix, bool upper) {
+        auto lengths = StringListLengths(list);
+        auto prefixes = StringListPrefixes(list);
+        size_t lo = 0;
+        size_t hi = StringListSize(list);
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            int cmp = StringListCompareKeys(prefixes[mid], lengths[mid], list[mid], prefix, len, str);
+            if (cmp < 0 || (upper && cmp == 0)) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    /// @brief Checks whether the entry equals a string with the given length and prefix.
+    bool entryEquals(char* const* list, size_t index, char const* str, size_t len, size_t prefix) {
+        if (StringListLengths(list)[index] != len || StringListPrefixes(list)[index] != prefix) return false;
+        if (len <= STRING_LIST_PREFIX_BYTES) return true; // the prefix holds the whole string
+        return memcmp(list[index] + STRING_LIST_PREFIX_BYTES, str + STRING_LIST_PREFIX_BYTES, len - STRING_LIST_PREFIX_BYTES) == 0;
+    }
+
+    /// @brief FNV-1a hash of an entry, seeded with its length and prefix.
+    size_t hashEntry(char* const* list, size_t index) {
+        size_t len = StringListLengths(list)[index];
+        size_t hash = 14695981039346656037ull ^ StringListPrefixes(list)[index] ^ (len * 0x9E3779B97F4A7C15ull);
+        for (size_t i = STRING_LIST_PREFIX_BYTES; i < len; ++i) {
+            hash = (hash ^ static_cast<unsigned char>(list[index][i])) * 1099511628211ull;
+        }
+        return hash ^ (hash >> 29);
+    }
+}
+
 char** StringListCreate() {
-    auto list = static_cast<char**>(malloc(sizeof(char*)));
+    auto header = static_cast<size_t*>(malloc(sizeof(size_t) * STRING_LIST_HEADER_WORDS + sizeof(char*)));
+    header[STRING_LIST_CAPACITY] = 0;
+    header[STRING_LIST_SIZE] = 0;
+    header[STRING_LIST_LENGTHS] = 0;
+    header[STRING_LIST_PREFIXES] = 0;
+    header[STRING_LIST_MAPPING] = 0;
+    header[STRING_LIST_MAPPING_SIZE] = 0;
+    header[STRING_LIST_FLAGS] = STRING_LIST_FLAG_SORTED; // an empty list is sorted
+
+    auto list = reinterpret_cast<char**>(header + STRING_LIST_HEADER_WORDS);
     list[0] = nullptr;
     return list;
 }
@@ -11,36 +134,77 @@ void StringListDestroy(char*** list) {
     if (list && *list) {
         auto ptr = *list;
         while (ptr && *ptr) {
-            free(*ptr);
+            releaseString(*list, *ptr);
             ++ptr;
         }
-        free(*list);
+
+        auto header = StringListHeader(*list);
+        size_t mapping = header[STRING_LIST_MAPPING];
+        size_t mappingSize = header[STRING_LIST_MAPPING_SIZE];
+        void* arrays[] = {StringListLengths(*list), StringListPrefixes(*list), header};
+        for (auto array : arrays) {
+            if (StringListOwns(*list, array)) free(array);
+        }
+        if (mapping) StringListUnmap(mapping, mappingSize);
         *list = nullptr;
     }
 }
 
 size_t StringListSize(char* const* list) {
-    size_t size = 0;
-    while (list[size]) size++;
-    return size;
+    return StringListHeader(list)[STRING_LIST_SIZE];
+}
+
+size_t StringListLength(char* const* list, size_t index) {
+    if (index >= StringListSize(list)) return 0; // out of bounds
+    return StringListLengths(list)[index];
 }
 
 void StringListAdd(char*** list, char const* str) {
     auto len = StringListSize(*list);
-    auto newList = static_cast<char**>(realloc(*list, sizeof(char*) * (len + 2)));
-    *list = newList;
-    newList[len] = static_cast<char*>(malloc(strlen(str) + 1));
-    strcpy(newList[len], str);
-    newList[len + 1] = nullptr;
+    auto strLen = strlen(str);
+    reserve(list, len + 1);
+    setEntry(*list, len, copyString(str, strLen), strLen);
+    setSize(*list, len + 1);
+    checkAppendedOrder(*list, len);
+}
+
+size_t StringListInsertSorted(char*** list, char const* str) {
+    if (!StringListIsSorted(*list)) StringListSort(*list);
+
+    auto len = StringListSize(*list);
+    auto strLen = strlen(str);
+    reserve(list, len + 1);
+
+    // insert after equal strings, so they stay in insertion order
+    auto index = searchSorted(*list, str, strLen, StringListPrefixOf(str, strLen), true);
+    size_t tail = len - index;
+    memmove(*list + index + 1, *list + index, sizeof(char*) * tail);
+    memmove(StringListLengths(*list) + index + 1, StringListLengths(*list) + index, sizeof(size_t) * tail);
+    memmove(StringListPrefixes(*list) + index + 1, StringListPrefixes(*list) + index, sizeof(size_t) * tail);
+    setEntry(*list, index, copyString(str, strLen), strLen);
+    setSize(*list, len + 1);
+    return index;
+}
+
+bool StringListIsSorted(char* const* list) {
+    return StringListHeader(list)[STRING_LIST_FLAGS] & STRING_LIST_FLAG_SORTED;
 }
 
 ssize_t StringListIndexOf(char* const* list, char const* str) {
-    ssize_t index = 0;
-    while (list[index]) {
-        if (strcmp(list[index], str) == 0) {
-            return index;
+    auto len = strlen(str);
+    auto prefix = StringListPrefixOf(str, len);
+    if (StringListIsSorted(list)) {
+        auto index = searchSorted(list, str, len, prefix, false);
+        if (index < StringListSize(list) && entryEquals(list, index, str, len, prefix)) {
+            return static_cast<ssize_t>(index);
+        }
+        return -1; // not found
+    }
+
+    for (size_t index = 0, size = StringListSize(list); index < size; ++index) {
+        if (entryEquals(list, index, str, len, prefix)) {
+            return static_cast<ssize_t>(index);
         }
-        ++index;
     }
     return -1; // not found
 }
@@ -49,12 +213,13 @@ void StringListRemoveAt(char** list, size_t index) {
     size_t len = StringListSize(list);
     if (index >= len) return; // out of bounds
 
-    free(list[index]);
+    releaseString(list, list[index]);
 
-    for (size_t i = index; i < len - 1; ++i) {
-        list[i] = list[i + 1];
-    }
-    list[len - 1] = nullptr;
+    size_t tail = len - index - 1;
+    memmove(list + index, list + index + 1, sizeof(char*) * tail);
+    memmove(StringListLengths(list) + index, StringListLengths(list) + index + 1, sizeof(size_t) * tail);
+    memmove(StringListPrefixes(list) + index, StringListPrefixes(list) + index + 1, sizeof(size_t) * tail);
+    setSize(list, len - 1);
 }
 
 void StringListRemove(char** list, char const* str) {
@@ -65,60 +230,283 @@ void StringListRemove(char** list, char const* str) {
 
 void StringListRemoveDuplicates(char** list) {
     size_t len = StringListSize(list);
-    for (size_t i = 0; i < len; ++i) {
-        for (size_t j = i + 1; j < len; ) {
-            if (strcmp(list[i], list[j]) == 0) {
-                StringListRemoveAt(list, j);
-                --len; // list size decreased
+    if (len <= 1) return;
+
+    // equal strings are adjacent in a sorted list
+    if (StringListIsSorted(list)) {
+        auto lengths = StringListLengths(list);
+        auto prefixes = StringListPrefixes(list);
+        size_t write = 1;
+        for (size_t read = 1; read < len; ++read) {
+            if (entryEquals(list, write - 1, list[read], lengths[read], prefixes[read])) {
+                releaseString(list, list[read]);
             } else {
-                ++j;
+                moveEntry(list, read, write++);
             }
         }
+        setSize(list, write);
+        return;
     }
+
+    // open addressing table of kept entries (index + 1, 0 is empty), at most half full
+    size_t tableSize = 1;
+    while (tableSize < len * 2) tableSize <<= 1;
+    auto table = static_cast<size_t*>(calloc(tableSize, sizeof(size_t)));
+
+    size_t write = 0;
+    for (size_t read = 0; read < len; ++read) {
+        size_t slot = hashEntry(list, read) & (tableSize - 1);
+        bool duplicate = false;
+        while (table[slot]) {
+            size_t kept = table[slot] - 1;
+            if (entryEquals(list, kept, list[read], StringListLengths(list)[read], StringListPrefixes(list)[read])) {
+                duplicate = true;
+                break;
+            }
+            slot = (slot + 1) & (tableSize - 1);
+        }
+
+        if (duplicate) {
+            releaseString(list, list[read]);
+        } else {
+            moveEntry(list, read, write);
+            table[slot] = ++write;
+        }
+    }
+    setSize(list, write);
+
+    free(table);
 }
 
-void StringListReplaceInStrings(char** list, char const* before, char const* after) {
-    auto len = StringListSize(list);
+void StringListAddRange(char*** list, char const* const* strings, size_t count) {
+    auto len = StringListSize(*list);
+    reserve(list, len + count);
+    for (size_t i = 0; i < count; ++i) {
+        auto strLen = strlen(strings[i]);
+        setEntry(*list, len + i, copyString(strings[i], strLen), strLen);
+    }
+    setSize(*list, len + count);
+    checkAppendedOrder(*list, len);
+}
+
+size_t StringListSplit(char*** list, char const* buffer, size_t length, char delimiter) {
+    if (length == 0) return 0;
+
+    // count the pieces first so the list grows only once
+    size_t count = 1;
+    for (auto pos = buffer; (pos = static_cast<char const*>(memchr(pos, delimiter, buffer + length - pos))); ++pos) {
+        ++count;
+    }
+    if (buffer[length - 1] == delimiter) --count; // no empty string after a trailing delimiter
+
+    auto len = StringListSize(*list);
+    reserve(list, len + count);
+
+    auto pos = buffer;
+    for (size_t i = 0; i < count; ++i) {
+        auto next = static_cast<char const*>(memchr(pos, delimiter, buffer + length - pos));
+        size_t size = (next ? next : buffer + length) - pos;
+        setEntry(*list, len + i, copyString(pos, size), size);
+        if (next) pos = next + 1;
+    }
+    setSize(*list, len + count);
+    checkAppendedOrder(*list, len);
+    return count;
+}
+
+size_t StringListRemoveIf(char** list, bool (*predicate)(char const* str, void* context), void* context) {
+    size_t len = StringListSize(list);
+    size_t write = 0;
+    for (size_t read = 0; read < len; ++read) {
+        if (predicate(list[read], context)) {
+            releaseString(list, list[read]);
+        } else {
+            moveEntry(list, read, write++);
+        }
+    }
+    setSize(list, write);
+    return len - write;
+}
+
+size_t StringListRemoveAll(char** list, char const* str) {
+    auto strLen = strlen(str);
+    auto prefix = StringListPrefixOf(str, strLen);
+
+    size_t len = StringListSize(list);
+    size_t write = 0;
+    for (size_t read = 0; read < len; ++read) {
+        if (entryEquals(list, read, str, strLen, prefix)) {
+            releaseString(list, list[read]);
+        } else {
+            moveEntry(list, read, write++);
+        }
+    }
+    setSize(list, write);
+    return len - write;
+}
+
+size_t StringListRemoveIndices(char** list, size_t const* indices, size_t count) {
+    size_t len = StringListSize(list);
+    auto removed = static_cast<bool*>(calloc(len + 1, sizeof(bool)));
+    for (size_t i = 0; i < count; ++i) {
+        if (indices[i] < len) removed[indices[i]] = true;
+    }
+
+    size_t write = 0;
+    for (size_t read = 0; read < len; ++read) {
+        if (removed[read]) {
+            releaseString(list, list[read]);
+        } else {
+            moveEntry(list, read, write++);
+        }
+    }
+    setSize(list, write);
+
+    free(removed);
+    return len - write;
+}
+
+void StringListClear(char** list) {
+    for (size_t i = 0; list[i]; ++i) {
+        releaseString(list, list[i]);
+    }
+    setSize(list, 0);
+}
+
+namespace {
+    /// @brief Fills the Boyer-Moore-Horspool bad character table for the given pattern.
+    void buildShiftTable(size_t* table, char const* pattern, size_t len) {
+        for (size_t c = 0; c < 256; ++c) table[c] = len;
+        for (size_t i = 0; i + 1 < len; ++i) {
+            table[static_cast<unsigned char>(pattern[i])] = len - 1 - i;
+        }
+    }
+
+    /// @brief Finds the next occurrence of the pattern in text[from, textLen).
+    /// @return Offset of the occurrence, or textLen if there is none.
+    size_t findNext(
+        char const* text, size_t textLen, size_t from,
+        char const* pattern, size_t patternLen, size_t const* shift
+    ) {
+        if (patternLen == 1) {
+            auto pos = static_cast<char const*>(memchr(text + from, pattern[0], textLen - from));
+            return pos ? static_cast<size_t>(pos - text) : textLen;
+        }
+
+        char const last = pattern[patternLen - 1];
+        while (from + patternLen <= textLen) {
+            char ch = text[from + patternLen - 1];
+            if (ch == last && memcmp(text + from, pattern, patternLen - 1) == 0) {
+                return from;
+            }
+            from += shift[static_cast<unsigned char>(ch)];
+        }
+        return textLen;
+    }
+}
+
+size_t StringListReplaceInStrings(char** list, char const* before, char const* after) {
     auto beforeLen = strlen(before);
     auto afterLen = strlen(after);
-    if (beforeLen == 0) return;
-
-    for (size_t i = 0; i < len; ++i) {
-        while (char* pos = strstr(list[i], before)) {
-            if (beforeLen >= afterLen) {
-                // no need to reallocate
-                memmove(pos + afterLen, pos + beforeLen, strlen(pos + beforeLen) + 1);
-                memcpy(pos, after, afterLen);
-            } else {
-                // new size is larger, need to reallocate
-                size_t newSize = strlen(list[i]) + (afterLen - beforeLen) + 1;
-                auto newStr = static_cast<char*>(malloc(newSize));
-                size_t prefixLen = pos - list[i];
-                memcpy(newStr, list[i], prefixLen);
-                memcpy(newStr + prefixLen, after, afterLen);
-                strcpy(newStr + prefixLen + afterLen, pos + beforeLen);
-                free(list[i]);
-                list[i] = newStr;
+    if (beforeLen == 0) return 0;
+
+    size_t shift[256];
+    buildShiftTable(shift, before, beforeLen);
+
+    // match offsets of the current string, reused for the whole list
+    size_t* matches = nullptr;
+    size_t matchesCapacity = 0;
+    size_t replaced = 0;
+
+    for (size_t i = 0, size = StringListSize(list); i < size; ++i) {
+        char* str = list[i];
+        size_t len = StringListLengths(list)[i];
+        if (len < beforeLen) continue;
+
+        // single left-to-right pass collecting non-overlapping matches
+        size_t count = 0;
+        size_t pos = findNext(str, len, 0, before, beforeLen, shift);
+        while (pos < len) {
+            if (count == matchesCapacity) {
+                matchesCapacity = matchesCapacity ? matchesCapacity * 2 : 16;
+                matches = static_cast<size_t*>(realloc(matches, sizeof(size_t) * matchesCapacity));
             }
+            matches[count++] = pos;
+            pos = findNext(str, len, pos + beforeLen, before, beforeLen, shift);
+        }
+        if (count == 0) continue;
+        replaced += count;
+
+        // shrinking replacements are done in place, growing ones need exactly one allocation
+        size_t newLen = len - count * beforeLen + count * afterLen;
+        char* out = afterLen <= beforeLen ? str : static_cast<char*>(malloc(newLen + 1));
+
+        size_t read = 0;
+        size_t write = 0;
+        for (size_t m = 0; m < count; ++m) {
+            size_t chunk = matches[m] - read;
+            memmove(out + write, str + read, chunk);
+            write += chunk;
+            memcpy(out + write, after, afterLen);
+            write += afterLen;
+            read = matches[m] + beforeLen;
         }
+        memmove(out + write, str + read, len - read + 1); // includes the terminator
+
+        if (out != str) releaseString(list, str);
+        setEntry(list, i, out, newLen);
     }
+
+    free(matches);
+    if (replaced) StringListSetSorted(list, false);
+    return replaced;
 }
 
 void StringListSort(char** list) {
     auto len = StringListSize(list);
-    if (len <= 1) return;
+    if (len <= 1 || StringListIsSorted(list)) return;
+
+    // stable bottom-up merge sort of entry indices, so the parallel arrays are permuted only once
+    auto order = static_cast<size_t*>(malloc(sizeof(size_t) * len));
+    auto buffer = static_cast<size_t*>(malloc(sizeof(size_t) * len));
+    for (size_t i = 0; i < len; ++i) order[i] = i;
 
-    for (size_t i = 0; i < len - 1; ++i) {
-        bool swapped = false;
-        for (size_t j = 0; j < len - i - 1; ++j) {
-            if (strcmp(list[j], list[j + 1]) > 0) {
-                char* temp = list[j];
-                list[j] = list[j + 1];
-                list[j + 1] = temp;
-                swapped = true;
+    for (size_t width = 1; width < len; width *= 2) {
+        for (size_t lo = 0; lo < len; lo += width * 2) {
+            size_t mid = lo + width < len ? lo + width : len;
+            size_t hi = lo + width * 2 < len ? lo + width * 2 : len;
+            size_t left = lo;
+            size_t right = mid;
+            size_t out = lo;
+            while (left < mid && right < hi) {
+                if (StringListCompareEntries(list, order[right], order[left]) < 0) {
+                    buffer[out++] = order[right++];
+                } else {
+                    buffer[out++] = order[left++];
+                }
             }
+            while (left < mid) buffer[out++] = order[left++];
+            while (right < hi) buffer[out++] = order[right++];
         }
 
-        if (!swapped) break;
+        auto temp = order;
+        order = buffer;
+        buffer = temp;
     }
-}
\ No newline at end of file
+
+    // gather every parallel array through the sorted order
+    auto strings = static_cast<char**>(malloc(sizeof(char*) * len));
+    for (size_t i = 0; i < len; ++i) strings[i] = list[order[i]];
+    memcpy(list, strings, sizeof(char*) * len);
+    free(strings);
+
+    size_t* arrays[] = {StringListLengths(list), StringListPrefixes(list)};
+    for (auto array : arrays) {
+        for (size_t i = 0; i < len; ++i) buffer[i] = array[order[i]];
+        memcpy(array, buffer, sizeof(size_t) * len);
+    }
+
+    free(buffer);
+    free(order);
+    StringListSetSorted(list, true);
+}
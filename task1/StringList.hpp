@@ -1,6 +1,10 @@
 #pragma once
 #include <cstdlib>
 
+// A string list is a null-terminated array of strings, so list[i] can be read directly.
+// Lists must be created with StringListCreate(): the array is preceded by a hidden header that caches
+// the size and the length and first bytes of every string, and is only kept up to date by these functions.
+
 /// @brief Creates an empty string list.
 /// @return Pointer to the created string list.
 char** StringListCreate();
@@ -14,12 +18,19 @@ void StringListDestroy(char*** list);
 /// @return The number of strings in the list.
 size_t StringListSize(char* const* list);
 
+/// @brief Returns the length of the string at the specified index, without scanning the string.
+/// @param list The string list.
+/// @param index The index of the string.
+/// @return The length of the string, or 0 if the index is out of bounds.
+size_t StringListLength(char* const* list, size_t index);
+
 /// @brief Adds a copy of the given string to the end of the list.
 /// @param list Pointer to the string list, which will be modified.
 /// @param str The string to add.
 void StringListAdd(char*** list, char const* str);
 
 /// @brief Returns the index of the first occurrence of the given string in the list, or -1 if not found.
+/// Uses binary search while the list is sorted (see StringListIsSorted()), a linear scan otherwise.
 /// @param list The string list.
 /// @param str The string to find.
 /// @return The index of the string, or -1 if not found.
@@ -37,15 +48,126 @@ void StringListRemoveAt(char** list, size_t index);
 void StringListRemove(char** list, char const* str);
 
 /// @brief Removes duplicate strings from the list, keeping only the first occurrence of each string.
+/// Sorted lists are deduplicated in a single linear pass.
 /// @param list The string list.
 void StringListRemoveDuplicates(char** list);
 
+/// @brief Adds copies of the given strings to the end of the list, growing the list only once.
+/// @param list Pointer to the string list, which will be modified.
+/// @param strings The strings to add.
+/// @param count The number of strings to add.
+void StringListAddRange(char*** list, char const* const* strings, size_t count);
+
+/// @brief Splits a buffer on a delimiter and adds every piece to the end of the list, growing the list only once.
+/// @param list Pointer to the string list, which will be modified.
+/// @param buffer The buffer to split, does not have to be null-terminated.
+/// @param length The length of the buffer in bytes.
+/// @param delimiter The character separating the pieces.
+/// @return The number of strings added.
+/// @note A trailing delimiter does not produce an empty string at the end.
+size_t StringListSplit(char*** list, char const* buffer, size_t length, char delimiter);
+
+/// @brief Removes all strings matching the predicate, keeping the order of the remaining strings.
+/// @param list The string list.
+/// @param predicate Function returning true for strings that should be removed.
+/// @param context User pointer passed to the predicate.
+/// @return The number of removed strings.
+size_t StringListRemoveIf(char** list, bool (*predicate)(char const* str, void* context), void* context);
+
+/// @brief Removes all occurrences of the given string from the list.
+/// @param list The string list.
+/// @param str The string to remove.
+/// @return The number of removed strings.
+size_t StringListRemoveAll(char** list, char const* str);
+
+/// @brief Removes the strings at the given indices in a single pass, keeping the order of the remaining strings.
+/// @param list The string list.
+/// @param indices The indices to remove, in any order. Duplicates and out of bounds indices are ignored.
+/// @param count The number of indices.
+/// @return The number of removed strings.
+size_t StringListRemoveIndices(char** list, size_t const* indices, size_t count);
+
+/// @brief Removes all strings from the list.
+/// @param list The string list.
+void StringListClear(char** list);
+
 /// @brief Replaces all occurrences of a substring in each string of the list with another substring.
+/// Occurrences are found in a single left-to-right pass and do not overlap, replaced text is not searched again.
 /// @param list The string list.
 /// @param before The substring to be replaced.
 /// @param after The substring to replace with.
-void StringListReplaceInStrings(char** list, char const* before, char const* after);
+/// @return The number of replacements made.
+size_t StringListReplaceInStrings(char** list, char const* before, char const* after);
+
+/// @brief Sorts the strings in the list in ascending lexicographical order using merge sort.
+/// The list remembers that it is sorted until it is modified in a way that breaks the order.
+/// @param list The string list.
+void StringListSort(char** list);
+
+/// @brief Checks whether the list is known to be sorted.
+/// This is true after sorting, and stays true through removals, ordered inserts and appends that keep the order.
+/// @param list The string list.
+/// @return True if the list is sorted.
+bool StringListIsSorted(char* const* list);
+
+/// @brief Inserts a copy of the given string at its sorted position, after any equal strings.
+/// @param list Pointer to the string list, which will be modified. It is sorted first if it is not sorted yet.
+/// @param str The string to insert.
+/// @return The index the string was inserted at.
+size_t StringListInsertSorted(char*** list, char const* str);
+
+/// @brief Sorts the strings in the list in ascending lexicographical order using a parallel sample sort.
+/// The resulting order is the same as produced by StringListSort().
+/// @param list The string list.
+/// @param threadCount Number of threads to use, or 0 to use all hardware threads.
+/// @note Small lists are sorted on the calling thread.
+void StringListSortParallel(char** list, size_t threadCount = 0);
+
+
+/// @brief Builds a multi-pattern matcher (Aho-Corasick automaton) for the given patterns.
+/// The automaton is stored in a single flat allocation and can be reused for any number of searches.
+/// @param patterns String list of patterns to search for. Empty patterns are ignored.
+/// @return Pointer to the created matcher.
+unsigned* StringListMatcherCreate(char* const* patterns);
+
+/// @brief Destroys a matcher and frees its memory. The pointer to the matcher is set to nullptr.
+/// @param matcher Pointer to the matcher to destroy.
+void StringListMatcherDestroy(unsigned** matcher);
 
-/// @brief Sorts the strings in the list in ascending lexicographical order using bubble sort.
+/// @brief Finds all strings in the list that contain at least one of the matcher patterns.
+/// Every string is scanned once, regardless of the number of patterns.
 /// @param list The string list.
-void StringListSort(char** list);
\ No newline at end of file
+/// @param matcher The matcher created with StringListMatcherCreate().
+/// @param indices Output buffer for the indices of matching strings, must hold StringListSize(list) entries.
+/// @return The number of matching strings written to indices, in ascending order.
+size_t StringListFindAll(char* const* list, unsigned const* matcher, size_t* indices);
+
+/// @brief Counts, for every pattern, the number of strings in the list that contain it.
+/// @param list The string list.
+/// @param matcher The matcher created with StringListMatcherCreate().
+/// @param counts Output buffer with one entry per pattern, in the order the patterns were given.
+void StringListCountMatches(char* const* list, unsigned const* matcher, size_t* counts);
+
+/// @brief Parallel version of StringListFindAll(), splitting the list across threads.
+/// @param threadCount Number of threads to use, or 0 to use all hardware threads.
+size_t StringListFindAllParallel(char* const* list, unsigned const* matcher, size_t* indices, size_t threadCount = 0);
+
+/// @brief Parallel version of StringListCountMatches(), splitting the list across threads.
+/// @param threadCount Number of threads to use, or 0 to use all hardware threads.
+void StringListCountMatchesParallel(char* const* list, unsigned const* matcher, size_t* counts, size_t threadCount = 0);
+
+
+/// @brief Saves the list to a file that can be loaded with StringListLoad().
+/// The file stores an offset table and a blob with all strings, in native byte order.
+/// @param list The string list.
+/// @param path The path of the file to write.
+/// @return True if the file was written successfully.
+bool StringListSave(char* const* list, char const* path);
+
+/// @brief Loads a list saved with StringListSave() by memory-mapping the file.
+/// Strings are used in place, without copying or allocating them. The list can be modified as usual:
+/// touched pages of the mapping are copied on write, and the arrays are moved to the heap when the list grows.
+/// @param path The path of the file to load.
+/// @return Pointer to the loaded string list, or nullptr if the file could not be loaded.
+/// @note The list must be destroyed with StringListDestroy(), which also releases the mapping.
+char** StringListLoad(char const* path);
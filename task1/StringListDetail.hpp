@@ -0,0 +1,95 @@
+#pragma once
+#include <cstdlib>
+
+// Internal helpers shared between the StringList translation units, not part of the public API.
+
+// Every list is preceded by a header of size_t words. The lengths and prefixes arrays run
+// parallel to the string pointers, so most comparisons can be decided without touching string bytes.
+constexpr size_t STRING_LIST_CAPACITY = 0; // number of string slots, not counting the terminator
+constexpr size_t STRING_LIST_SIZE = 1;     // number of strings
+constexpr size_t STRING_LIST_LENGTHS = 2;  // size_t* with the cached strlen of every string
+constexpr size_t STRING_LIST_PREFIXES = 3; // size_t* with the first bytes of every string, see StringListPrefixOf()
+constexpr size_t STRING_LIST_MAPPING = 4;  // base address of the file mapping of a loaded list, or 0
+constexpr size_t STRING_LIST_MAPPING_SIZE = 5;
+constexpr size_t STRING_LIST_FLAGS = 6;    // bit set of STRING_LIST_FLAG_* values
+constexpr size_t STRING_LIST_HEADER_WORDS = 7;
+
+// the strings are in ascending order, set by sorting and kept by removals and ordered inserts
+constexpr size_t STRING_LIST_FLAG_SORTED = 1;
+
+// number of string bytes stored in a prefix
+constexpr size_t STRING_LIST_PREFIX_BYTES = sizeof(size_t);
+
+inline size_t* StringListHeader(char* const* list) {
+    return reinterpret_cast<size_t*>(const_cast<char**>(list)) - STRING_LIST_HEADER_WORDS;
+}
+
+inline size_t* StringListLengths(char* const* list) {
+    return reinterpret_cast<size_t*>(StringListHeader(list)[STRING_LIST_LENGTHS]);
+}
+
+inline size_t* StringListPrefixes(char* const* list) {
+    return reinterpret_cast<size_t*>(StringListHeader(list)[STRING_LIST_PREFIXES]);
+}
+
+/// @brief Checks whether the memory was allocated by the list, rather than being part of its file mapping.
+/// Lists loaded with StringListLoad() keep pointing into the mapping until an entry or array is replaced.
+inline bool StringListOwns(char* const* list, void const* ptr) {
+    auto header = StringListHeader(list);
+    return reinterpret_cast<size_t>(ptr) - header[STRING_LIST_MAPPING] >= header[STRING_LIST_MAPPING_SIZE];
+}
+
+/// @brief Releases the file mapping of a loaded list.
+void StringListUnmap(size_t base, size_t size);
+
+/// @brief Packs the first bytes of a string big-endian into a word, padding with zeros.
+/// Comparing two prefixes as integers gives the same order as comparing the strings' first bytes.
+inline size_t StringListPrefixOf(char const* str, size_t len) {
+    size_t prefix = 0;
+    for (size_t i = 0; i < STRING_LIST_PREFIX_BYTES; ++i) {
+        prefix <<= 8;
+        if (i < len) prefix |= static_cast<unsigned char>(str[i]);
+    }
+    return prefix;
+}
+
+/// @brief Three-way lexicographical comparison of two strings, using their prefixes and lengths first.
+inline int StringListCompareKeys(
+    size_t prefixA, size_t lenA, char const* a,
+    size_t prefixB, size_t lenB, char const* b
+) {
+    if (prefixA != prefixB) return prefixA < prefixB ? -1 : 1;
+
+    // equal prefixes: if either string ends within the prefix, the shorter one is smaller
+    if (lenA <= STRING_LIST_PREFIX_BYTES || lenB <= STRING_LIST_PREFIX_BYTES) {
+        return lenA < lenB ? -1 : lenA > lenB ? 1 : 0;
+    }
+
+    auto lhs = reinterpret_cast<unsigned char const*>(a) + STRING_LIST_PREFIX_BYTES;
+    auto rhs = reinterpret_cast<unsigned char const*>(b) + STRING_LIST_PREFIX_BYTES;
+    while (*lhs && *lhs == *rhs) ++lhs, ++rhs;
+    return *lhs < *rhs ? -1 : *lhs > *rhs ? 1 : 0;
+}
+
+/// @brief Three-way lexicographical comparison of two entries.
+inline int StringListCompareEntries(char* const* list, size_t a, size_t b) {
+    auto prefixes = StringListPrefixes(list);
+    auto lengths = StringListLengths(list);
+    return StringListCompareKeys(prefixes[a], lengths[a], list[a], prefixes[b], lengths[b], list[b]);
+}
+
+inline void StringListSetSorted(char* const* list, bool sorted) {
+    auto& flags = StringListHeader(list)[STRING_LIST_FLAGS];
+    flags = sorted ? flags | STRING_LIST_FLAG_SORTED : flags & ~STRING_LIST_FLAG_SORTED;
+}
+
+/// @brief Returns the number of patterns the matcher was built from.
+size_t StringListMatcherPatternCount(unsigned const* matcher);
+
+/// @brief Checks whether the string contains at least one pattern of the matcher.
+bool StringListMatcherAny(unsigned const* matcher, char const* str);
+
+/// @brief Increments counts[p] for every pattern p found in the string, once per string.
+/// @param seen Scratch buffer with one entry per pattern, holding the stamp of the last string a pattern was found in.
+/// @param stamp Unique non-zero value identifying the current string.
+void StringListMatcherCount(unsigned const* matcher, char const* str, size_t* counts, size_t* seen, size_t stamp);
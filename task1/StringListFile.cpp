@@ -0,0 +1,128 @@
+#include "StringList.hpp"
+#include "StringListDetail.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// File layout, all fields are native size_t words:
+//   [0] magic, [1] number of strings, [2] size of the string blob in bytes
+//   list header      STRING_LIST_HEADER_WORDS words, only the flags are stored, the rest is filled in when loaded
+//   string offsets   count + 1 words, offsets into the blob, turned into pointers when loaded
+//   lengths          count words
+//   prefixes         count words
+//   blob             all strings with their terminators, padded to a whole word
+// The list header is followed directly by the string slots, exactly like a list in memory,
+// so a loaded file is used in place and only the offsets have to be turned into pointers.
+
+namespace {
+    constexpr size_t FILE_MAGIC = 0x3154534C52545331ull; // "1STRLST1"
+    constexpr size_t FILE_HEADER_WORDS = 3;
+
+    size_t blobWords(size_t blobSize) {
+        return (blobSize + sizeof(size_t) - 1) / sizeof(size_t);
+    }
+
+    size_t fileWords(size_t count, size_t blobSize) {
+        return FILE_HEADER_WORDS + STRING_LIST_HEADER_WORDS + (count + 1) + count * 2 + blobWords(blobSize);
+    }
+}
+
+bool StringListSave(char* const* list, char const* path) {
+    FILE* file = fopen(path, "wb");
+    if (!file) return false;
+
+    size_t count = StringListSize(list);
+    auto lengths = StringListLengths(list);
+
+    size_t blobSize = 0;
+    for (size_t i = 0; i < count; ++i) blobSize += lengths[i] + 1;
+
+    // header, placeholder list header and offsets are written in one go
+    size_t tableWords = FILE_HEADER_WORDS + STRING_LIST_HEADER_WORDS + count + 1;
+    auto table = static_cast<size_t*>(calloc(tableWords, sizeof(size_t)));
+    table[0] = FILE_MAGIC;
+    table[1] = count;
+    table[2] = blobSize;
+    table[FILE_HEADER_WORDS + STRING_LIST_FLAGS] = StringListHeader(list)[STRING_LIST_FLAGS];
+    auto offsets = table + FILE_HEADER_WORDS + STRING_LIST_HEADER_WORDS;
+    for (size_t i = 0, offset = 0; i < count; ++i) {
+        offsets[i] = offset;
+        offset += lengths[i] + 1;
+    }
+
+    bool ok = fwrite(table, sizeof(size_t), tableWords, file) == tableWords;
+    free(table);
+    // an empty list has no length and prefix arrays, fwrite must not be given null pointers
+    if (count > 0) {
+        ok = ok && fwrite(lengths, sizeof(size_t), count, file) == count;
+        ok = ok && fwrite(StringListPrefixes(list), sizeof(size_t), count, file) == count;
+    }
+    for (size_t i = 0; ok && i < count; ++i) {
+        ok = fwrite(list[i], 1, lengths[i] + 1, file) == lengths[i] + 1;
+    }
+
+    size_t const padding = 0;
+    size_t paddingSize = blobWords(blobSize) * sizeof(size_t) - blobSize;
+    ok = ok && fwrite(&padding, 1, paddingSize, file) == paddingSize;
+
+    return fclose(file) == 0 && ok;
+}
+
+char** StringListLoad(char const* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return nullptr;
+
+    struct stat info{};
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(size_t) * fileWords(0, 0)) {
+        close(fd);
+        return nullptr;
+    }
+
+    // private writable mapping: mutating the list copies only the touched pages
+    size_t size = info.st_size;
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) return nullptr;
+
+    auto words = static_cast<size_t*>(mapping);
+    size_t count = words[1];
+    size_t blobSize = words[2];
+    if (words[0] != FILE_MAGIC || count > size / sizeof(size_t) || blobSize > size
+        || fileWords(count, blobSize) * sizeof(size_t) != size) {
+        munmap(mapping, size);
+        return nullptr;
+    }
+
+    auto header = words + FILE_HEADER_WORDS;
+    auto list = reinterpret_cast<char**>(header + STRING_LIST_HEADER_WORDS);
+    auto lengths = header + STRING_LIST_HEADER_WORDS + count + 1;
+    auto prefixes = lengths + count;
+    auto blob = reinterpret_cast<char*>(prefixes + count);
+
+    header[STRING_LIST_CAPACITY] = count;
+    header[STRING_LIST_SIZE] = count;
+    header[STRING_LIST_LENGTHS] = count ? reinterpret_cast<size_t>(lengths) : 0;
+    header[STRING_LIST_PREFIXES] = count ? reinterpret_cast<size_t>(prefixes) : 0;
+    header[STRING_LIST_MAPPING] = reinterpret_cast<size_t>(mapping);
+    header[STRING_LIST_MAPPING_SIZE] = size;
+
+    for (size_t i = 0; i < count; ++i) {
+        size_t offset = reinterpret_cast<size_t*>(list)[i];
+        if (offset >= blobSize || lengths[i] >= blobSize - offset || blob[offset + lengths[i]] != '\0') {
+            munmap(mapping, size);
+            return nullptr;
+        }
+        list[i] = blob + offset;
+    }
+    list[count] = nullptr;
+
+    return list;
+}
+
+void StringListUnmap(size_t base, size_t size) {
+    munmap(reinterpret_cast<void*>(base), size);
+}
@@ -0,0 +1,188 @@
+#include "StringList.hpp"
+#include "StringListDetail.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+    // lists smaller than this are not worth spinning up threads for
+    constexpr size_t MIN_PARALLEL_SIZE = 1 << 15;
+    // each bucket should hold at least this many strings
+    constexpr size_t MIN_BUCKET_SIZE = 1 << 13;
+    // minimum number of strings per thread for matcher scans
+    constexpr size_t MIN_SCAN_CHUNK = 1 << 10;
+    // number of samples taken per bucket to pick the splitters
+    constexpr size_t OVERSAMPLING = 64;
+
+    /// Runs fn(0) .. fn(count - 1) in parallel, using the calling thread for index 0.
+    template <typename Fn>
+    void runParallel(size_t count, Fn const& fn) {
+        std::vector<std::jthread> workers;
+        workers.reserve(count - 1);
+        for (size_t i = 1; i < count; ++i) {
+            workers.emplace_back(fn, i);
+        }
+        fn(0);
+    }
+
+    size_t resolveThreadCount(size_t threadCount, size_t len, size_t minChunk) {
+        if (threadCount == 0) threadCount = std::thread::hardware_concurrency();
+        return std::max<size_t>(1, std::min(threadCount, len / minChunk));
+    }
+}
+
+void StringListSortParallel(char** list, size_t threadCount) {
+    auto len = StringListSize(list);
+
+    threadCount = resolveThreadCount(threadCount, len, MIN_BUCKET_SIZE);
+    if (threadCount == 1 || len < MIN_PARALLEL_SIZE || StringListIsSorted(list)) {
+        StringListSort(list);
+        return;
+    }
+
+    // entries are sorted by index, comparing cached prefixes and lengths before string bytes
+    auto const lessThan = [list](size_t a, size_t b) {
+        return StringListCompareEntries(list, a, b) < 0;
+    };
+
+    // every thread owns one input chunk and one output bucket
+    size_t const buckets = threadCount;
+
+    // pick splitters from a sorted regular sample
+    size_t const sampleCount = buckets * OVERSAMPLING;
+    auto samples = static_cast<size_t*>(malloc(sizeof(size_t) * sampleCount));
+    for (size_t i = 0; i < sampleCount; ++i) {
+        samples[i] = i * len / sampleCount;
+    }
+    std::sort(samples, samples + sampleCount, lessThan);
+
+    auto splitters = static_cast<size_t*>(malloc(sizeof(size_t) * (buckets - 1)));
+    for (size_t b = 1; b < buckets; ++b) {
+        splitters[b - 1] = samples[b * OVERSAMPLING];
+    }
+    free(samples);
+
+    auto bucketOf = static_cast<unsigned*>(malloc(sizeof(unsigned) * len));
+    auto offsets = static_cast<size_t*>(calloc(threadCount * buckets, sizeof(size_t)));
+    auto bucketStart = static_cast<size_t*>(malloc(sizeof(size_t) * (buckets + 1)));
+    auto order = static_cast<size_t*>(malloc(sizeof(size_t) * len));
+
+    auto const chunkBegin = [&](size_t t) { return t * len / threadCount; };
+
+    // classify every entry of a chunk and count bucket sizes
+    runParallel(threadCount, [&](size_t t) {
+        auto counts = offsets + t * buckets;
+        for (size_t i = chunkBegin(t), end = chunkBegin(t + 1); i < end; ++i) {
+            auto b = std::upper_bound(splitters, splitters + buckets - 1, i, lessThan) - splitters;
+            bucketOf[i] = static_cast<unsigned>(b);
+            ++counts[b];
+        }
+    });
+
+    // turn the counts into write offsets: bucket-major, then by chunk, so the scatter is stable
+    size_t position = 0;
+    for (size_t b = 0; b < buckets; ++b) {
+        bucketStart[b] = position;
+        for (size_t t = 0; t < threadCount; ++t) {
+            auto count = offsets[t * buckets + b];
+            offsets[t * buckets + b] = position;
+            position += count;
+        }
+    }
+    bucketStart[buckets] = len;
+
+    // scatter entries into their buckets
+    runParallel(threadCount, [&](size_t t) {
+        auto cursor = offsets + t * buckets;
+        for (size_t i = chunkBegin(t), end = chunkBegin(t + 1); i < end; ++i) {
+            order[cursor[bucketOf[i]]++] = i;
+        }
+    });
+
+    // buckets are ordered by the splitters, so sorting each one sorts the whole list,
+    // the parallel arrays are then gathered into fresh copies through the sorted order
+    size_t capacity = StringListHeader(list)[STRING_LIST_CAPACITY];
+    auto strings = static_cast<char**>(malloc(sizeof(char*) * len));
+    auto lengths = static_cast<size_t*>(malloc(sizeof(size_t) * capacity));
+    auto prefixes = static_cast<size_t*>(malloc(sizeof(size_t) * capacity));
+    runParallel(buckets, [&](size_t b) {
+        auto first = bucketStart[b];
+        auto last = bucketStart[b + 1];
+        std::stable_sort(order + first, order + last, lessThan);
+        for (size_t i = first; i < last; ++i) {
+            strings[i] = list[order[i]];
+            lengths[i] = StringListLengths(list)[order[i]];
+            prefixes[i] = StringListPrefixes(list)[order[i]];
+        }
+    });
+
+    memcpy(list, strings, sizeof(char*) * len);
+    if (StringListOwns(list, StringListLengths(list))) free(StringListLengths(list));
+    if (StringListOwns(list, StringListPrefixes(list))) free(StringListPrefixes(list));
+    StringListHeader(list)[STRING_LIST_LENGTHS] = reinterpret_cast<size_t>(lengths);
+    StringListHeader(list)[STRING_LIST_PREFIXES] = reinterpret_cast<size_t>(prefixes);
+
+    free(strings);
+    free(order);
+    free(bucketStart);
+    free(offsets);
+    free(bucketOf);
+    free(splitters);
+    StringListSetSorted(list, true);
+}
+
+size_t StringListFindAllParallel(char* const* list, unsigned const* matcher, size_t* indices, size_t threadCount) {
+    auto len = StringListSize(list);
+    threadCount = resolveThreadCount(threadCount, len, MIN_SCAN_CHUNK);
+    if (threadCount == 1) return StringListFindAll(list, matcher, indices);
+
+    // every thread writes its matches at the start of its own chunk of the output
+    auto found = static_cast<size_t*>(calloc(threadCount, sizeof(size_t)));
+    runParallel(threadCount, [&](size_t t) {
+        size_t begin = t * len / threadCount;
+        size_t end = (t + 1) * len / threadCount;
+        for (size_t i = begin; i < end; ++i) {
+            if (StringListMatcherAny(matcher, list[i])) {
+                indices[begin + found[t]++] = i;
+            }
+        }
+    });
+
+    // close the gaps between chunks
+    size_t total = found[0];
+    for (size_t t = 1; t < threadCount; ++t) {
+        memmove(indices + total, indices + t * len / threadCount, sizeof(size_t) * found[t]);
+        total += found[t];
+    }
+
+    free(found);
+    return total;
+}
+
+void StringListCountMatchesParallel(char* const* list, unsigned const* matcher, size_t* counts, size_t threadCount) {
+    auto len = StringListSize(list);
+    threadCount = resolveThreadCount(threadCount, len, MIN_SCAN_CHUNK);
+    if (threadCount == 1) return StringListCountMatches(list, matcher, counts);
+
+    // per-thread counters and scratch, summed up afterwards
+    size_t patternCount = StringListMatcherPatternCount(matcher);
+    auto partial = static_cast<size_t*>(calloc(threadCount * patternCount * 2, sizeof(size_t)));
+    runParallel(threadCount, [&](size_t t) {
+        auto threadCounts = partial + t * patternCount * 2;
+        auto seen = threadCounts + patternCount;
+        for (size_t i = t * len / threadCount, end = (t + 1) * len / threadCount; i < end; ++i) {
+            StringListMatcherCount(matcher, list[i], threadCounts, seen, i + 1);
+        }
+    });
+
+    memset(counts, 0, sizeof(size_t) * patternCount);
+    for (size_t t = 0; t < threadCount; ++t) {
+        for (size_t p = 0; p < patternCount; ++p) {
+            counts[p] += partial[t * patternCount * 2 + p];
+        }
+    }
+
+    free(partial);
+}
@@ -0,0 +1,181 @@
+#include "StringList.hpp"
+#include "StringListDetail.hpp"
+#include <cstring>
+
+// Matcher layout, all fields are unsigned:
+//   [0] number of byte classes, [1] number of states, [2] number of patterns
+//   [3 .. 259)  byte -> class map (class 0 is every byte that appears in no pattern)
+//   transitions  states * classes, fully resolved, so scanning is one lookup per byte
+//   terminal     per state: first pattern id + 1 ending in this state, or 0
+//   dictLink     per state: nearest proper suffix state that is terminal, or 0
+//   patternNext  per pattern: next pattern id + 1 ending in the same state, or 0 (duplicate patterns)
+
+namespace {
+    constexpr size_t MATCHER_HEADER = 3 + 256;
+
+    size_t matcherSize(size_t classes, size_t states, size_t patterns) {
+        return MATCHER_HEADER + states * classes + states * 2 + patterns;
+    }
+
+    unsigned const* transitionsOf(unsigned const* matcher) { return matcher + MATCHER_HEADER; }
+    unsigned const* terminalOf(unsigned const* matcher) { return transitionsOf(matcher) + matcher[1] * matcher[0]; }
+    unsigned const* dictLinkOf(unsigned const* matcher) { return terminalOf(matcher) + matcher[1]; }
+    unsigned const* patternNextOf(unsigned const* matcher) { return dictLinkOf(matcher) + matcher[1]; }
+}
+
+unsigned* StringListMatcherCreate(char* const* patterns) {
+    size_t patternCount = StringListSize(patterns);
+
+    // compress the alphabet to the bytes that actually appear in patterns
+    unsigned classMap[256] = {};
+    size_t classes = 1;
+    size_t maxStates = 1;
+    for (size_t p = 0; p < patternCount; ++p) {
+        for (auto ch = reinterpret_cast<unsigned char const*>(patterns[p]); *ch; ++ch) {
+            if (!classMap[*ch]) classMap[*ch] = static_cast<unsigned>(classes++);
+            ++maxStates;
+        }
+    }
+
+    // build the trie
+    auto transitions = static_cast<unsigned*>(calloc(maxStates * classes, sizeof(unsigned)));
+    auto terminal = static_cast<unsigned*>(calloc(maxStates, sizeof(unsigned)));
+    auto patternNext = static_cast<unsigned*>(calloc(patternCount ? patternCount : 1, sizeof(unsigned)));
+    size_t states = 1;
+    for (size_t p = 0; p < patternCount; ++p) {
+        if (!*patterns[p]) continue; // empty patterns never match
+
+        size_t state = 0;
+        for (auto ch = reinterpret_cast<unsigned char const*>(patterns[p]); *ch; ++ch) {
+            auto& next = transitions[state * classes + classMap[*ch]];
+            if (!next) next = static_cast<unsigned>(states++);
+            state = next;
+        }
+
+        // chain duplicates behind the first pattern of this state, keeping the input order
+        if (!terminal[state]) {
+            terminal[state] = static_cast<unsigned>(p + 1);
+        } else {
+            size_t last = terminal[state] - 1;
+            while (patternNext[last]) last = patternNext[last] - 1;
+            patternNext[last] = static_cast<unsigned>(p + 1);
+        }
+    }
+
+    // resolve failure links breadth-first, turning the trie into a full automaton
+    auto fail = static_cast<unsigned*>(calloc(states, sizeof(unsigned)));
+    auto dictLink = static_cast<unsigned*>(calloc(states, sizeof(unsigned)));
+    auto queue = static_cast<unsigned*>(malloc(sizeof(unsigned) * states));
+    size_t head = 0;
+    size_t tail = 0;
+    for (size_t c = 0; c < classes; ++c) {
+        if (auto child = transitions[c]) queue[tail++] = child;
+    }
+    while (head < tail) {
+        size_t state = queue[head++];
+        for (size_t c = 0; c < classes; ++c) {
+            auto& next = transitions[state * classes + c];
+            auto fallback = transitions[fail[state] * classes + c];
+            if (!next) {
+                next = fallback;
+                continue;
+            }
+            fail[next] = fallback;
+            dictLink[next] = terminal[fallback] ? fallback : dictLink[fallback];
+            queue[tail++] = next;
+        }
+    }
+
+    // pack everything into one flat block
+    auto matcher = static_cast<unsigned*>(malloc(sizeof(unsigned) * matcherSize(classes, states, patternCount)));
+    matcher[0] = static_cast<unsigned>(classes);
+    matcher[1] = static_cast<unsigned>(states);
+    matcher[2] = static_cast<unsigned>(patternCount);
+    memcpy(matcher + 3, classMap, sizeof(classMap));
+    auto out = matcher + MATCHER_HEADER;
+    memcpy(out, transitions, sizeof(unsigned) * states * classes);
+    out += states * classes;
+    memcpy(out, terminal, sizeof(unsigned) * states);
+    out += states;
+    memcpy(out, dictLink, sizeof(unsigned) * states);
+    out += states;
+    memcpy(out, patternNext, sizeof(unsigned) * patternCount);
+
+    free(queue);
+    free(dictLink);
+    free(fail);
+    free(patternNext);
+    free(terminal);
+    free(transitions);
+    return matcher;
+}
+
+void StringListMatcherDestroy(unsigned** matcher) {
+    if (matcher && *matcher) {
+        free(*matcher);
+        *matcher = nullptr;
+    }
+}
+
+size_t StringListMatcherPatternCount(unsigned const* matcher) {
+    return matcher[2];
+}
+
+bool StringListMatcherAny(unsigned const* matcher, char const* str) {
+    size_t const classes = matcher[0];
+    auto classMap = matcher + 3;
+    auto transitions = transitionsOf(matcher);
+    auto terminal = terminalOf(matcher);
+    auto dictLink = dictLinkOf(matcher);
+
+    size_t state = 0;
+    for (auto ch = reinterpret_cast<unsigned char const*>(str); *ch; ++ch) {
+        state = transitions[state * classes + classMap[*ch]];
+        if (terminal[state] || dictLink[state]) return true;
+    }
+    return false;
+}
+
+void StringListMatcherCount(unsigned const* matcher, char const* str, size_t* counts, size_t* seen, size_t stamp) {
+    size_t const classes = matcher[0];
+    auto classMap = matcher + 3;
+    auto transitions = transitionsOf(matcher);
+    auto terminal = terminalOf(matcher);
+    auto dictLink = dictLinkOf(matcher);
+    auto patternNext = patternNextOf(matcher);
+
+    size_t state = 0;
+    for (auto ch = reinterpret_cast<unsigned char const*>(str); *ch; ++ch) {
+        state = transitions[state * classes + classMap[*ch]];
+
+        // every terminal suffix of the current state ends a pattern here
+        for (size_t match = terminal[state] ? state : dictLink[state]; match; match = dictLink[match]) {
+            for (size_t id = terminal[match]; id; id = patternNext[id - 1]) {
+                if (seen[id - 1] == stamp) continue;
+                seen[id - 1] = stamp;
+                ++counts[id - 1];
+            }
+        }
+    }
+}
+
+size_t StringListFindAll(char* const* list, unsigned const* matcher, size_t* indices) {
+    size_t found = 0;
+    for (size_t i = 0; list[i]; ++i) {
+        if (StringListMatcherAny(matcher, list[i])) {
+            indices[found++] = i;
+        }
+    }
+    return found;
+}
+
+void StringListCountMatches(char* const* list, unsigned const* matcher, size_t* counts) {
+    size_t patternCount = StringListMatcherPatternCount(matcher);
+    memset(counts, 0, sizeof(size_t) * patternCount);
+
+    auto seen = static_cast<size_t*>(calloc(patternCount ? patternCount : 1, sizeof(size_t)));
+    for (size_t i = 0; list[i]; ++i) {
+        StringListMatcherCount(matcher, list[i], counts, seen, i + 1);
+    }
+    free(seen);
+}
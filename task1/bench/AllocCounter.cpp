@@ -0,0 +1,52 @@
+#include "AllocCounter.hpp"
+#include <atomic>
+
+namespace {
+    std::atomic<size_t> allocations{0};
+    std::atomic<size_t> frees{0};
+    std::atomic<size_t> bytes{0};
+
+    void countAllocation(size_t size) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+}
+
+AllocStats allocStats() {
+    return {
+        allocations.load(std::memory_order_relaxed),
+        frees.load(std::memory_order_relaxed),
+        bytes.load(std::memory_order_relaxed),
+    };
+}
+
+#if defined(__GLIBC__)
+
+extern "C" {
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* ptr, size_t size);
+    void __libc_free(void* ptr);
+
+    void* malloc(size_t size) noexcept {
+        countAllocation(size);
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size) noexcept {
+        countAllocation(count * size);
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* ptr, size_t size) noexcept {
+        countAllocation(size);
+        return __libc_realloc(ptr, size);
+    }
+
+    void free(void* ptr) noexcept {
+        if (ptr) frees.fetch_add(1, std::memory_order_relaxed);
+        __libc_free(ptr);
+    }
+}
+
+#endif
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <benchmark/benchmark.h>
+
+// Counts heap allocations made through malloc/calloc/realloc/free by the whole process.
+// The counting is done by interposing the allocator in AllocCounter.cpp (glibc only,
+// on other platforms all counters stay zero).
+
+struct AllocStats {
+    size_t allocations = 0; // malloc, calloc and realloc calls
+    size_t frees = 0;       // free calls with a non-null pointer
+    size_t bytes = 0;       // bytes requested by allocations
+
+    AllocStats operator-(AllocStats const& other) const {
+        return {allocations - other.allocations, frees - other.frees, bytes - other.bytes};
+    }
+
+    AllocStats& operator+=(AllocStats const& other) {
+        allocations += other.allocations;
+        frees += other.frees;
+        bytes += other.bytes;
+        return *this;
+    }
+};
+
+/// @brief Returns the allocation counters accumulated since the start of the process.
+AllocStats allocStats();
+
+/// @brief Accumulates the allocations of the timed part of every benchmark iteration.
+class AllocTracker {
+public:
+    void start() { m_start = allocStats(); }
+    void stop() { m_total += allocStats() - m_start; }
+
+    /// @brief Adds per-iteration allocation counters to the benchmark output.
+    void report(benchmark::State& state) const {
+        using benchmark::Counter;
+        state.counters["allocs"] = Counter(static_cast<double>(m_total.allocations), Counter::kAvgIterations);
+        state.counters["frees"] = Counter(static_cast<double>(m_total.frees), Counter::kAvgIterations);
+        state.counters["bytes"] = Counter(static_cast<double>(m_total.bytes), Counter::kAvgIterations, Counter::kIs1024);
+    }
+
+private:
+    AllocStats m_start;
+    AllocStats m_total;
+};
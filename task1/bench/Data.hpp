@@ -0,0 +1,80 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "StringList.hpp"
+
+// Benchmark inputs. The strings of a dataset are stored back to back in one buffer,
+// which is cheap to hold for millions of strings and lets lists be built with StringListAddRange().
+
+namespace bench {
+    enum class Kind {
+        Words, // identifiers: log-normal lengths, median around 10, long tail capped at 200
+        Paths, // source file paths: shared directory prefixes followed by a short file name
+    };
+
+    struct Dataset {
+        std::string storage;              // null-separated strings
+        std::vector<char const*> strings; // pointers into storage
+
+        [[nodiscard]] size_t size() const { return strings.size(); }
+    };
+
+    inline void appendWord(std::string& out, std::mt19937_64& rng) {
+        static constexpr char ALPHABET[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_";
+        std::lognormal_distribution<double> length(std::log(10.0), 0.6);
+        std::uniform_int_distribution<size_t> symbol(0, sizeof(ALPHABET) - 2);
+
+        auto len = std::clamp<size_t>(static_cast<size_t>(length(rng)), 1, 200);
+        for (size_t j = 0; j < len; ++j) out += ALPHABET[symbol(rng)];
+    }
+
+    inline void appendPath(std::string& out, std::mt19937_64& rng) {
+        static constexpr char const* ROOTS[] = {"src/", "include/", "third_party/", "tests/"};
+        static constexpr char const* EXTENSIONS[] = {".cpp", ".hpp", ".c", ".h"};
+        std::uniform_int_distribution<size_t> depth(1, 4);
+        std::uniform_int_distribution<size_t> module(0, 63);
+        std::uniform_int_distribution<size_t> file(0, 99'999);
+
+        out += ROOTS[rng() % std::size(ROOTS)];
+        for (size_t d = depth(rng); d > 0; --d) {
+            out += "module_" + std::to_string(module(rng)) + '/';
+        }
+        out += "file_" + std::to_string(file(rng)) + EXTENSIONS[rng() % std::size(EXTENSIONS)];
+    }
+
+    /// Returns a cached dataset with the given number of strings.
+    inline Dataset const& dataset(Kind kind, size_t count) {
+        static std::map<std::pair<Kind, size_t>, Dataset> cache;
+        auto [it, inserted] = cache.try_emplace({kind, count});
+        if (!inserted) return it->second;
+
+        auto& data = it->second;
+        std::mt19937_64 rng(count);
+        std::vector<size_t> offsets(count);
+        for (size_t i = 0; i < count; ++i) {
+            offsets[i] = data.storage.size();
+            if (kind == Kind::Words) appendWord(data.storage, rng);
+            else appendPath(data.storage, rng);
+            data.storage += '\0';
+        }
+
+        data.strings.resize(count);
+        for (size_t i = 0; i < count; ++i) data.strings[i] = data.storage.data() + offsets[i];
+        return data;
+    }
+
+    /// Builds a list holding the first count strings of the dataset.
+    inline char** makeList(Dataset const& data, size_t count) {
+        char** list = StringListCreate();
+        StringListAddRange(&list, data.strings.data(), count);
+        return list;
+    }
+
+    inline char** makeList(Dataset const& data) {
+        return makeList(data, data.size());
+    }
+}
@@ -0,0 +1,43 @@
+#include <algorithm>
+#include <thread>
+#include <benchmark/benchmark.h>
+#include "AllocCounter.hpp"
+#include "Data.hpp"
+#include "StringList.hpp"
+
+// Scaling of the parallel sort from one thread up to all hardware threads.
+static void BM_SortParallel(benchmark::State& state) {
+    auto const& data = bench::dataset(bench::Kind::Words, state.range(0));
+    auto const threads = static_cast<size_t>(state.range(1));
+
+    AllocTracker allocs;
+    for (auto _ : state) {
+        state.PauseTiming();
+        char** list = bench::makeList(data);
+        allocs.start();
+        state.ResumeTiming();
+
+        StringListSortParallel(list, threads);
+        benchmark::ClobberMemory();
+
+        state.PauseTiming();
+        allocs.stop();
+        StringListDestroy(&list);
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    allocs.report(state);
+}
+
+BENCHMARK(BM_SortParallel)
+    ->Apply([](benchmark::internal::Benchmark* bench) {
+        long maxThreads = std::max(1u, std::thread::hardware_concurrency());
+        for (long size : {1L << 16, 1L << 20}) {
+            for (long threads = 1; threads < maxThreads; threads *= 2) bench->Args({size, threads});
+            bench->Args({size, maxThreads});
+        }
+    })
+    ->ArgNames({"size", "threads"})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
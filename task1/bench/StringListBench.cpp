@@ -0,0 +1,148 @@
+#include <random>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "AllocCounter.hpp"
+#include "Data.hpp"
+#include "StringList.hpp"
+
+// Every StringList operation at 1e3 .. 1e7 strings. Lists are built outside of the timed region,
+// and the allocation counters only cover the timed operation.
+
+namespace {
+    void listSizes(benchmark::internal::Benchmark* bench) {
+        bench->RangeMultiplier(10)->Range(1'000, 10'000'000)->ArgName("size");
+    }
+
+    /// Runs op on a freshly built list in every iteration, timing only op.
+    template <typename Build, typename Op>
+    void runOnFreshList(benchmark::State& state, Build const& build, Op const& op) {
+        AllocTracker allocs;
+        for (auto _ : state) {
+            state.PauseTiming();
+            char** list = build();
+            allocs.start();
+            state.ResumeTiming();
+
+            op(list);
+            benchmark::ClobberMemory();
+
+            state.PauseTiming();
+            allocs.stop();
+            StringListDestroy(&list);
+            state.ResumeTiming();
+        }
+        allocs.report(state);
+    }
+
+    /// Lookup keys: strings of the list spread over its whole range, plus strings that are not in it.
+    std::vector<char const*> lookupKeys(bench::Dataset const& data) {
+        static constexpr char const* MISSING[] = {"", "not in the list", "zzzzzzzzzzzzzzzzzzzzzzzzzzzz"};
+        std::mt19937_64 rng(data.size());
+        std::vector<char const*> keys;
+        for (size_t i = 0; i < 61; ++i) keys.push_back(data.strings[rng() % data.size()]);
+        for (auto key : MISSING) keys.push_back(key);
+        return keys;
+    }
+}
+
+static void BM_Add(benchmark::State& state) {
+    auto const& data = bench::dataset(bench::Kind::Words, state.range(0));
+    AllocTracker allocs;
+    for (auto _ : state) {
+        allocs.start();
+        char** list = StringListCreate();
+        for (auto str : data.strings) StringListAdd(&list, str);
+        benchmark::ClobberMemory();
+        allocs.stop();
+
+        state.PauseTiming();
+        StringListDestroy(&list);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    allocs.report(state);
+}
+BENCHMARK(BM_Add)->Apply(listSizes)->Unit(benchmark::kMillisecond);
+
+static void BM_AddRange(benchmark::State& state) {
+    auto const& data = bench::dataset(bench::Kind::Words, state.range(0));
+    AllocTracker allocs;
+    for (auto _ : state) {
+        allocs.start();
+        char** list = bench::makeList(data);
+        benchmark::ClobberMemory();
+        allocs.stop();
+
+        state.PauseTiming();
+        StringListDestroy(&list);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    allocs.report(state);
+}
+BENCHMARK(BM_AddRange)->Apply(listSizes)->Unit(benchmark::kMillisecond);
+
+static void BM_IndexOf(benchmark::State& state, bool sorted) {
+    auto const& data = bench::dataset(bench::Kind::Paths, state.range(0));
+    auto const keys = lookupKeys(data);
+    char** list = bench::makeList(data);
+    if (sorted) StringListSort(list);
+
+    AllocTracker allocs;
+    size_t next = 0;
+    for (auto _ : state) {
+        allocs.start();
+        benchmark::DoNotOptimize(StringListIndexOf(list, keys[next++ % keys.size()]));
+        allocs.stop();
+    }
+    state.SetItemsProcessed(state.iterations());
+    allocs.report(state);
+
+    StringListDestroy(&list);
+}
+BENCHMARK_CAPTURE(BM_IndexOf, linear, false)->Apply(listSizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_IndexOf, sorted, true)->Apply(listSizes)->Unit(benchmark::kMicrosecond);
+
+static void BM_RemoveAt(benchmark::State& state) {
+    constexpr size_t REMOVALS = 64;
+    auto const& data = bench::dataset(bench::Kind::Words, state.range(0));
+    runOnFreshList(state, [&] { return bench::makeList(data); }, [&](char** list) {
+        for (size_t i = 0; i < REMOVALS; ++i) StringListRemoveAt(list, StringListSize(list) / 2);
+    });
+    state.SetItemsProcessed(state.iterations() * REMOVALS);
+}
+BENCHMARK(BM_RemoveAt)->Apply(listSizes)->Unit(benchmark::kMicrosecond);
+
+// every string appears twice: the second half of the list repeats the first half
+static void BM_RemoveDuplicates(benchmark::State& state, bool sorted) {
+    auto const& data = bench::dataset(bench::Kind::Words, state.range(0) / 2);
+    auto build = [&] {
+        char** list = bench::makeList(data);
+        StringListAddRange(&list, data.strings.data(), data.size());
+        if (sorted) StringListSort(list);
+        return list;
+    };
+    runOnFreshList(state, build, [](char** list) { StringListRemoveDuplicates(list); });
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_CAPTURE(BM_RemoveDuplicates, unsorted, false)->Apply(listSizes)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_RemoveDuplicates, sorted, true)->Apply(listSizes)->Unit(benchmark::kMillisecond);
+
+static void BM_ReplaceInStrings(benchmark::State& state, char const* before, char const* after) {
+    auto const& data = bench::dataset(bench::Kind::Paths, state.range(0));
+    runOnFreshList(state, [&] { return bench::makeList(data); }, [&](char** list) {
+        benchmark::DoNotOptimize(StringListReplaceInStrings(list, before, after));
+    });
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_CAPTURE(BM_ReplaceInStrings, shrink, "module_", "m")->Apply(listSizes)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ReplaceInStrings, grow, "file_", "source_file_")->Apply(listSizes)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ReplaceInStrings, miss, "missing", "x")->Apply(listSizes)->Unit(benchmark::kMillisecond);
+
+static void BM_Sort(benchmark::State& state, bench::Kind kind) {
+    auto const& data = bench::dataset(kind, state.range(0));
+    runOnFreshList(state, [&] { return bench::makeList(data); }, [](char** list) { StringListSort(list); });
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_CAPTURE(BM_Sort, words, bench::Kind::Words)->Apply(listSizes)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Sort, paths, bench::Kind::Paths)->Apply(listSizes)->Unit(benchmark::kMillisecond);
@@ -1,5 +1,8 @@
+#include <algorithm>
 #include <cstdio>
+#include <random>
 #include <string>
+#include <vector>
 #include <gtest/gtest.h>
 #include "StringList.hpp"
 
@@ -159,7 +162,7 @@ TEST(StringListTest, ReplaceInStrings) {
     StringListAdd(&list, "Goodbye World");
 
     // Replace "Hello" with "Hi"
-    StringListReplaceInStrings(list, "Hello", "Hi");
+    EXPECT_EQ(StringListReplaceInStrings(list, "Hello", "Hi"), 2);
     EXPECT_STREQ(list[0], "Hi World");
     EXPECT_STREQ(list[1], "Hi Universe");
     EXPECT_STREQ(list[2], "Goodbye World"); // Should remain unchanged
@@ -182,6 +185,22 @@ TEST(StringListTest, ReplaceInStrings) {
     StringListReplaceInStrings(list, "cat", "dog");
     EXPECT_STREQ(list[0], "dog");
 
+    // Test replacement containing the searched text
+    StringListDestroy(&list);
+    list = StringListCreate();
+    StringListAdd(&list, "a-a-a");
+    StringListAdd(&list, "none");
+    EXPECT_EQ(StringListReplaceInStrings(list, "a", "aa"), 3);
+    EXPECT_STREQ(list[0], "aa-aa-aa");
+    EXPECT_STREQ(list[1], "none");
+
+    // Test non-overlapping matches and missing substring
+    StringListAdd(&list, "xxxxx");
+    EXPECT_EQ(StringListReplaceInStrings(list, "xx", "y"), 2);
+    EXPECT_STREQ(list[2], "yyx");
+    EXPECT_EQ(StringListReplaceInStrings(list, "missing", "z"), 0);
+    EXPECT_EQ(StringListReplaceInStrings(list, "", "z"), 0);
+
     StringListDestroy(&list);
 }
 
@@ -286,6 +305,368 @@ TEST(StringListTest, BasicOperations) {
     EXPECT_EQ(mylist, nullptr);
 }
 
+// Test parallel sorting
+TEST(StringListTest, SortParallel) {
+    char** list = StringListCreate();
+
+    // small lists are sorted on the calling thread
+    StringListAdd(&list, "Zebra");
+    StringListAdd(&list, "Apple");
+    StringListAdd(&list, "Monkey");
+    StringListSortParallel(list, 4);
+    EXPECT_STREQ(list[0], "Apple");
+    EXPECT_STREQ(list[1], "Monkey");
+    EXPECT_STREQ(list[2], "Zebra");
+    StringListDestroy(&list);
+
+    // large list with many duplicates, compared against std::sort
+    list = StringListCreate();
+    std::vector<std::string> expected;
+    std::mt19937 rng(42);
+    for (size_t i = 0; i < 40'000; ++i) {
+        auto str = std::to_string(rng() % 20'000);
+        expected.push_back(str);
+        StringListAdd(&list, str.c_str());
+    }
+    std::sort(expected.begin(), expected.end());
+
+    StringListSortParallel(list, 4);
+    ASSERT_EQ(StringListSize(list), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_STREQ(list[i], expected[i].c_str());
+        ASSERT_EQ(StringListLength(list, i), expected[i].size());
+    }
+    auto first = std::lower_bound(expected.begin(), expected.end(), expected.back()) - expected.begin();
+    EXPECT_EQ(StringListIndexOf(list, expected.back().c_str()), first);
+
+    // sorting an already sorted list keeps it unchanged
+    StringListSortParallel(list, 3);
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_STREQ(list[i], expected[i].c_str());
+    }
+
+    StringListDestroy(&list);
+}
+
+// Test multi-pattern search
+TEST(StringListTest, FindAll) {
+    char** patterns = StringListCreate();
+    StringListAdd(&patterns, "he");
+    StringListAdd(&patterns, "she");
+    StringListAdd(&patterns, "his");
+    StringListAdd(&patterns, "hers");
+    StringListAdd(&patterns, "he"); // Duplicate
+    StringListAdd(&patterns, "");   // Ignored
+    unsigned* matcher = StringListMatcherCreate(patterns);
+
+    char** list = StringListCreate();
+    StringListAdd(&list, "ushers");
+    StringListAdd(&list, "nothing");
+    StringListAdd(&list, "this");
+    StringListAdd(&list, "");
+    StringListAdd(&list, "HE");
+    StringListAdd(&list, "the theme");
+
+    size_t indices[6];
+    ASSERT_EQ(StringListFindAll(list, matcher, indices), 3);
+    EXPECT_EQ(indices[0], 0);
+    EXPECT_EQ(indices[1], 2);
+    EXPECT_EQ(indices[2], 5);
+
+    // every pattern is counted once per string
+    size_t counts[6];
+    StringListCountMatches(list, matcher, counts);
+    EXPECT_EQ(counts[0], 2); // he
+    EXPECT_EQ(counts[1], 1); // she
+    EXPECT_EQ(counts[2], 1); // his
+    EXPECT_EQ(counts[3], 1); // hers
+    EXPECT_EQ(counts[4], 2); // he (duplicate)
+    EXPECT_EQ(counts[5], 0); // empty pattern
+
+    StringListDestroy(&list);
+    StringListMatcherDestroy(&matcher);
+    EXPECT_EQ(matcher, nullptr);
+    StringListDestroy(&patterns);
+}
+
+// Test parallel multi-pattern search against the sequential one
+TEST(StringListTest, FindAllParallel) {
+    char** patterns = StringListCreate();
+    for (int i = 0; i < 50; ++i) {
+        StringListAdd(&patterns, std::to_string(i * 7919).c_str());
+    }
+    unsigned* matcher = StringListMatcherCreate(patterns);
+
+    char** list = StringListCreate();
+    std::mt19937 rng(7);
+    for (size_t i = 0; i < 10'000; ++i) {
+        StringListAdd(&list, std::to_string(rng()).c_str());
+    }
+
+    std::vector<size_t> expected(10'000), actual(10'000);
+    auto expectedCount = StringListFindAll(list, matcher, expected.data());
+    ASSERT_EQ(StringListFindAllParallel(list, matcher, actual.data(), 4), expectedCount);
+    expected.resize(expectedCount);
+    actual.resize(expectedCount);
+    EXPECT_EQ(actual, expected);
+
+    std::vector<size_t> expectedCounts(50), actualCounts(50);
+    StringListCountMatches(list, matcher, expectedCounts.data());
+    StringListCountMatchesParallel(list, matcher, actualCounts.data(), 4);
+    EXPECT_EQ(actualCounts, expectedCounts);
+
+    StringListDestroy(&list);
+    StringListMatcherDestroy(&matcher);
+    StringListDestroy(&patterns);
+}
+
+// Test batch adding
+TEST(StringListTest, AddRange) {
+    char** list = StringListCreate();
+    StringListAdd(&list, "First");
+
+    char const* strings[] = {"Second", "", "Third"};
+    StringListAddRange(&list, strings, 3);
+    EXPECT_EQ(StringListSize(list), 4);
+    EXPECT_STREQ(list[0], "First");
+    EXPECT_STREQ(list[1], "Second");
+    EXPECT_STREQ(list[2], "");
+    EXPECT_STREQ(list[3], "Third");
+
+    StringListAddRange(&list, strings, 0);
+    EXPECT_EQ(StringListSize(list), 4);
+
+    StringListDestroy(&list);
+}
+
+// Test splitting a buffer into the list
+TEST(StringListTest, Split) {
+    char** list = StringListCreate();
+
+    char const buffer[] = "alpha\nbeta\n\ngamma\n";
+    EXPECT_EQ(StringListSplit(&list, buffer, sizeof(buffer) - 1, '\n'), 4);
+    EXPECT_EQ(StringListSize(list), 4);
+    EXPECT_STREQ(list[0], "alpha");
+    EXPECT_STREQ(list[1], "beta");
+    EXPECT_STREQ(list[2], "");
+    EXPECT_STREQ(list[3], "gamma");
+
+    // Buffer without a trailing delimiter and not null-terminated
+    EXPECT_EQ(StringListSplit(&list, "a,b,cXYZ", 5, ','), 3);
+    EXPECT_EQ(StringListSize(list), 7);
+    EXPECT_STREQ(list[4], "a");
+    EXPECT_STREQ(list[6], "c");
+
+    EXPECT_EQ(StringListSplit(&list, "", 0, ','), 0);
+    EXPECT_EQ(StringListSize(list), 7);
+
+    StringListDestroy(&list);
+}
+
+// Test batch removal
+TEST(StringListTest, RemoveIf) {
+    char** list = StringListCreate();
+    char const* strings[] = {"apple", "banana", "avocado", "cherry", "apple", "blueberry"};
+    StringListAddRange(&list, strings, 6);
+
+    auto startsWith = [](char const* str, void* context) {
+        return str[0] == *static_cast<char*>(context);
+    };
+    char letter = 'b';
+    EXPECT_EQ(StringListRemoveIf(list, startsWith, &letter), 2);
+    EXPECT_EQ(StringListSize(list), 4);
+    EXPECT_STREQ(list[0], "apple");
+    EXPECT_STREQ(list[1], "avocado");
+    EXPECT_STREQ(list[2], "cherry");
+    EXPECT_STREQ(list[3], "apple");
+
+    EXPECT_EQ(StringListRemoveAll(list, "apple"), 2);
+    EXPECT_EQ(StringListSize(list), 2);
+    EXPECT_STREQ(list[0], "avocado");
+    EXPECT_STREQ(list[1], "cherry");
+    EXPECT_EQ(StringListRemoveAll(list, "NotFound"), 0);
+
+    StringListClear(list);
+    EXPECT_EQ(StringListSize(list), 0);
+    StringListAdd(&list, "again");
+    EXPECT_STREQ(list[0], "again");
+
+    StringListDestroy(&list);
+}
+
+// Test removing by a set of indices
+TEST(StringListTest, RemoveIndices) {
+    char** list = StringListCreate();
+    char const* strings[] = {"0", "1", "2", "3", "4", "5"};
+    StringListAddRange(&list, strings, 6);
+
+    size_t indices[] = {4, 0, 4, 2, 100};
+    EXPECT_EQ(StringListRemoveIndices(list, indices, 5), 3);
+    EXPECT_EQ(StringListSize(list), 3);
+    EXPECT_STREQ(list[0], "1");
+    EXPECT_STREQ(list[1], "3");
+    EXPECT_STREQ(list[2], "5");
+
+    StringListDestroy(&list);
+}
+
+// Test cached lengths and prefix comparisons
+TEST(StringListTest, CachedLengths) {
+    char** list = StringListCreate();
+
+    StringListAdd(&list, "shared/prefix/one");
+    StringListAdd(&list, "shared/prefix/two");
+    StringListAdd(&list, "shared/p");
+    StringListAdd(&list, "shared/pr");
+    StringListAdd(&list, "short");
+    EXPECT_EQ(StringListLength(list, 0), 17);
+    EXPECT_EQ(StringListLength(list, 2), 8);
+    EXPECT_EQ(StringListLength(list, 4), 5);
+    EXPECT_EQ(StringListLength(list, 5), 0); // out of bounds
+
+    // same prefix and length, different tail
+    EXPECT_EQ(StringListIndexOf(list, "shared/prefix/two"), 1);
+    EXPECT_EQ(StringListIndexOf(list, "shared/prefix/six"), -1);
+    EXPECT_EQ(StringListIndexOf(list, "shared/p"), 2);
+    EXPECT_EQ(StringListIndexOf(list, "shared/"), -1);
+
+    // lengths follow replacements and removals
+    EXPECT_EQ(StringListReplaceInStrings(list, "prefix", "x"), 2);
+    EXPECT_EQ(StringListLength(list, 0), 12);
+    EXPECT_EQ(StringListIndexOf(list, "shared/x/one"), 0);
+    StringListRemoveAt(list, 0);
+    EXPECT_EQ(StringListLength(list, 0), 12);
+    EXPECT_STREQ(list[0], "shared/x/two");
+
+    StringListSort(list);
+    EXPECT_STREQ(list[0], "shared/p");
+    EXPECT_STREQ(list[1], "shared/pr");
+    EXPECT_STREQ(list[2], "shared/x/two");
+    EXPECT_STREQ(list[3], "short");
+    EXPECT_EQ(StringListLength(list, 1), 9);
+    EXPECT_EQ(StringListLength(list, 3), 5);
+    EXPECT_EQ(list[4], nullptr);
+
+    StringListDestroy(&list);
+}
+
+// Test saving and loading a memory-mapped list
+TEST(StringListTest, SaveAndLoad) {
+    auto path = testing::TempDir() + "string_list_test.bin";
+
+    char** list = StringListCreate();
+    char const* strings[] = {"First", "", "a considerably longer string", "Last"};
+    StringListAddRange(&list, strings, 4);
+    ASSERT_TRUE(StringListSave(list, path.c_str()));
+    StringListDestroy(&list);
+
+    list = StringListLoad(path.c_str());
+    ASSERT_NE(list, nullptr);
+    EXPECT_EQ(StringListSize(list), 4);
+    EXPECT_STREQ(list[0], "First");
+    EXPECT_STREQ(list[1], "");
+    EXPECT_STREQ(list[2], "a considerably longer string");
+    EXPECT_STREQ(list[3], "Last");
+    EXPECT_EQ(list[4], nullptr);
+    EXPECT_EQ(StringListLength(list, 2), 28);
+    EXPECT_EQ(StringListIndexOf(list, "Last"), 3);
+
+    // mutations work on loaded lists, mixing mapped and owned strings
+    EXPECT_EQ(StringListReplaceInStrings(list, "Last", "Very Last"), 1);
+    StringListRemoveAt(list, 1);
+    StringListAdd(&list, "Added");
+    StringListSort(list);
+    EXPECT_EQ(StringListSize(list), 4);
+    EXPECT_STREQ(list[0], "Added");
+    EXPECT_STREQ(list[1], "First");
+    EXPECT_STREQ(list[2], "Very Last");
+    EXPECT_STREQ(list[3], "a considerably longer string");
+    StringListDestroy(&list);
+
+    // the file itself is not modified by mutations
+    list = StringListLoad(path.c_str());
+    ASSERT_NE(list, nullptr);
+    EXPECT_STREQ(list[3], "Last");
+    StringListClear(list);
+    EXPECT_EQ(StringListSize(list), 0);
+    StringListDestroy(&list);
+
+    // empty lists round-trip as well
+    list = StringListCreate();
+    ASSERT_TRUE(StringListSave(list, path.c_str()));
+    StringListDestroy(&list);
+    list = StringListLoad(path.c_str());
+    ASSERT_NE(list, nullptr);
+    EXPECT_EQ(StringListSize(list), 0);
+    StringListAdd(&list, "grown");
+    EXPECT_STREQ(list[0], "grown");
+    StringListDestroy(&list);
+
+    // missing and foreign files are rejected
+    EXPECT_EQ(StringListLoad((path + ".missing").c_str()), nullptr);
+    FILE* file = std::fopen(path.c_str(), "wb");
+    std::fputs("definitely not a string list, but long enough to hold a header", file);
+    std::fclose(file);
+    EXPECT_EQ(StringListLoad(path.c_str()), nullptr);
+    std::remove(path.c_str());
+}
+
+// Test sorted mode
+TEST(StringListTest, SortedMode) {
+    char** list = StringListCreate();
+    EXPECT_TRUE(StringListIsSorted(list));
+
+    // appending in order keeps the list sorted
+    StringListAdd(&list, "Apple");
+    StringListAdd(&list, "Banana");
+    EXPECT_TRUE(StringListIsSorted(list));
+    StringListAdd(&list, "Aardvark");
+    EXPECT_FALSE(StringListIsSorted(list));
+
+    StringListSort(list);
+    EXPECT_TRUE(StringListIsSorted(list));
+
+    // ordered inserts, equal strings go after existing ones
+    EXPECT_EQ(StringListInsertSorted(&list, "Cherry"), 3);
+    EXPECT_EQ(StringListInsertSorted(&list, "Apple"), 2);
+    EXPECT_EQ(StringListInsertSorted(&list, ""), 0);
+    EXPECT_EQ(StringListInsertSorted(&list, "Apple"), 4);
+    EXPECT_TRUE(StringListIsSorted(list));
+    EXPECT_EQ(StringListSize(list), 7);
+    EXPECT_STREQ(list[0], "");
+    EXPECT_STREQ(list[1], "Aardvark");
+    EXPECT_STREQ(list[2], "Apple");
+    EXPECT_STREQ(list[5], "Banana");
+    EXPECT_STREQ(list[6], "Cherry");
+    EXPECT_EQ(list[7], nullptr);
+
+    // binary search finds the first match
+    EXPECT_EQ(StringListIndexOf(list, "Apple"), 2);
+    EXPECT_EQ(StringListIndexOf(list, "Cherry"), 6);
+    EXPECT_EQ(StringListIndexOf(list, ""), 0);
+    EXPECT_EQ(StringListIndexOf(list, "Apricot"), -1);
+    EXPECT_EQ(StringListIndexOf(list, "Zebra"), -1);
+
+    // removals keep the order, deduplication is a linear pass
+    StringListRemove(list, "Banana");
+    EXPECT_TRUE(StringListIsSorted(list));
+    StringListRemoveDuplicates(list);
+    EXPECT_EQ(StringListSize(list), 4);
+    EXPECT_STREQ(list[2], "Apple");
+    EXPECT_STREQ(list[3], "Cherry");
+
+    // replacements may break the order
+    StringListReplaceInStrings(list, "Cherry", "Avocado");
+    EXPECT_FALSE(StringListIsSorted(list));
+    EXPECT_EQ(StringListIndexOf(list, "Avocado"), 3);
+
+    // inserting into an unsorted list sorts it first
+    EXPECT_EQ(StringListInsertSorted(&list, "Banana"), 4);
+    EXPECT_STREQ(list[3], "Avocado");
+
+    StringListDestroy(&list);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,220 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <ranges>
+#include <span>
+#include <vector>
+#include "AnyType.hpp"
+
+// Binary format for sequences of AnyType values:
+//   header   "ANY", format version, sizeof(long), payload bytes of a long double, 1 if little-endian, 0
+//   value    tag byte (the Type) followed by the payload of the value
+//   run      tag byte with ANY_RUN_FLAG set, 4-byte count, then count payloads back to back
+// A payload is the value's own bytes in native order: sizeof(T), except for long double, of which
+// only the bytes carrying the value are kept (10 for the x87 80-bit format). Fields are unaligned,
+// so the reader works directly on any buffer, a file mapping included, and decodes a value only
+// when it is dereferenced. The header describes the writer's ABI, buffers from another ABI are rejected.
+
+namespace detail {
+    constexpr std::uint8_t ANY_FORMAT_VERSION = 1;
+    constexpr std::size_t ANY_HEADER_SIZE = 8;
+    constexpr std::uint8_t ANY_RUN_FLAG = 0x80;
+    constexpr std::size_t ANY_RUN_HEADER_SIZE = 1 + sizeof(std::uint32_t);
+
+    // below this length a run header costs more than the tags it saves
+    constexpr std::size_t ANY_MIN_RUN = ANY_RUN_HEADER_SIZE + 1;
+
+    constexpr std::array<std::byte, ANY_HEADER_SIZE> ANY_HEADER = {
+        std::byte{'A'}, std::byte{'N'}, std::byte{'Y'}, std::byte{ANY_FORMAT_VERSION},
+        std::byte{sizeof(long)}, std::byte{ANY_LONG_DOUBLE_BYTES},
+        std::byte{std::endian::native == std::endian::little}, std::byte{0},
+    };
+}
+
+class AnyWriter {
+public:
+    AnyWriter() { m_buffer.assign(detail::ANY_HEADER.begin(), detail::ANY_HEADER.end()); }
+
+    template <AnyLayout Layout>
+    void write(BasicAnyType<Layout> const& value) {
+        m_buffer.push_back(static_cast<std::byte>(value.type()));
+        visit([&](auto x) { appendPayload(x); }, value);
+    }
+
+    // writes a sequence of values, storing stretches of the same type as runs
+    template <std::ranges::forward_range R> requires detail::isAnyType<std::ranges::range_value_t<R>>
+    void write(R const& values) {
+        auto it = std::ranges::begin(values);
+        auto const last = std::ranges::end(values);
+        while (it != last) {
+            auto const type = it->type();
+            auto runEnd = std::ranges::find_if(std::next(it), last, [&](auto const& value) { return value.type() != type; });
+            auto length = static_cast<std::size_t>(std::ranges::distance(it, runEnd));
+            if (length < detail::ANY_MIN_RUN) {
+                for (; it != runEnd; ++it) write(*it);
+                continue;
+            }
+
+            while (length > 0) {
+                auto count = static_cast<std::uint32_t>(std::min<std::size_t>(length, std::numeric_limits<std::uint32_t>::max()));
+                appendRunHeader(type, count);
+                for (std::uint32_t i = 0; i < count; ++i, ++it) visit([&](auto x) { appendPayload(x); }, *it);
+                length -= count;
+            }
+        }
+    }
+
+    // writes values of one type as runs, without going through AnyType
+    template <typename T> requires std::is_arithmetic_v<T>
+    void write_run(std::span<T const> values) {
+        for (std::size_t done = 0; done < values.size();) {
+            auto count = static_cast<std::uint32_t>(std::min<std::size_t>(values.size() - done, std::numeric_limits<std::uint32_t>::max()));
+            appendRunHeader(AnyTypeBase::type_of<T>(), count);
+            for (std::uint32_t i = 0; i < count; ++i) appendPayload(values[done + i]);
+            done += count;
+        }
+    }
+
+    [[nodiscard]] std::span<std::byte const> data() const noexcept { return m_buffer; }
+
+    void clear() { m_buffer.resize(detail::ANY_HEADER_SIZE); }
+
+private:
+    void appendRunHeader(AnyTypeBase::Type type, std::uint32_t count) {
+        m_buffer.push_back(static_cast<std::byte>(static_cast<std::uint8_t>(type) | detail::ANY_RUN_FLAG));
+        auto bytes = std::bit_cast<std::array<std::byte, sizeof(count)>>(count);
+        m_buffer.insert(m_buffer.end(), bytes.begin(), bytes.end());
+    }
+
+    template <typename T>
+    void appendPayload(T value) {
+        auto bytes = std::bit_cast<std::array<std::byte, sizeof(T)>>(value);
+        m_buffer.insert(m_buffer.end(), bytes.begin(), bytes.begin() + detail::anyPayloadSize<T>);
+    }
+
+    std::vector<std::byte> m_buffer;
+};
+
+// Reads a buffer written by AnyWriter in place. Values are decoded one at a time while iterating,
+// iteration stops early at malformed data or at a type the layout cannot hold, valid() tells those apart.
+template <AnyLayout Layout = AnyLayout::Wide>
+class BasicAnyReader {
+public:
+    using Type = AnyTypeBase::Type;
+    using value_type = BasicAnyType<Layout>;
+
+    explicit BasicAnyReader(std::span<std::byte const> data) noexcept {
+        if (data.size() >= detail::ANY_HEADER_SIZE
+            && std::memcmp(data.data(), detail::ANY_HEADER.data(), detail::ANY_HEADER_SIZE) == 0) {
+            m_data = data.subspan(detail::ANY_HEADER_SIZE);
+            m_headerValid = true;
+        }
+    }
+
+    class iterator {
+    public:
+        using value_type = BasicAnyType<Layout>;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() noexcept = default;
+
+        value_type operator*() const noexcept { return detail::ANY_LOADERS<value_type>[m_type](m_pos); }
+
+        iterator& operator++() noexcept {
+            m_pos += detail::ANY_PAYLOAD_SIZES[m_type];
+            if (--m_remaining == 0) nextRecord();
+            return *this;
+        }
+
+        iterator operator++(int) noexcept {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        bool operator==(std::default_sentinel_t) const noexcept { return m_remaining == 0; }
+
+    private:
+        friend class BasicAnyReader;
+
+        iterator(std::byte const* first, std::byte const* last) noexcept : m_pos(first), m_end(last) { nextRecord(); }
+
+        void nextRecord() noexcept {
+            std::size_t count = 0;
+            auto record = readRecord(m_pos, m_end, m_type, count);
+            if (!record || !detail::ANY_LOADERS<value_type>[m_type]) {
+                m_remaining = 0;
+                return;
+            }
+            m_pos = record;
+            m_remaining = count;
+        }
+
+        std::byte const* m_pos = nullptr;
+        std::byte const* m_end = nullptr;
+        std::size_t m_type = 0;
+        std::size_t m_remaining = 0;
+    };
+
+    [[nodiscard]] iterator begin() const noexcept {
+        if (!m_headerValid) return {};
+        return iterator(m_data.data(), m_data.data() + m_data.size());
+    }
+
+    [[nodiscard]] std::default_sentinel_t end() const noexcept { return {}; }
+
+    // Calls f(type, count, payloads) for every value or run, payloads pointing at count payloads
+    // back to back in the buffer. Returns false if the buffer is malformed.
+    template <typename F>
+    bool for_each_record(F&& f) const {
+        if (!m_headerValid) return false;
+        auto pos = m_data.data();
+        auto const last = m_data.data() + m_data.size();
+        while (pos != last) {
+            std::size_t type = 0;
+            std::size_t count = 0;
+            auto payload = readRecord(pos, last, type, count);
+            if (!payload) return false;
+            f(static_cast<Type>(type), count, payload);
+            pos = payload + count * detail::ANY_PAYLOAD_SIZES[type];
+        }
+        return true;
+    }
+
+    // checks the header and the structure of every record, without decoding values
+    [[nodiscard]] bool valid() const noexcept {
+        return for_each_record([](Type, std::size_t, std::byte const*) {});
+    }
+
+private:
+    // Reads the record header at pos. Returns its first payload and sets type and count,
+    // or returns nullptr at the end of the buffer or if the record is malformed or truncated.
+    static std::byte const* readRecord(std::byte const* pos, std::byte const* last, std::size_t& type, std::size_t& count) noexcept {
+        if (pos == last) return nullptr;
+        auto tag = static_cast<std::uint8_t>(*pos++);
+        type = tag & ~detail::ANY_RUN_FLAG;
+        if (type >= detail::ANY_TYPE_COUNT) return nullptr;
+
+        count = 1;
+        if (tag & detail::ANY_RUN_FLAG) {
+            std::uint32_t length;
+            if (static_cast<std::size_t>(last - pos) < sizeof(length)) return nullptr;
+            std::memcpy(&length, pos, sizeof(length));
+            pos += sizeof(length);
+            count = length;
+        }
+        if (count == 0 || static_cast<std::size_t>(last - pos) / detail::ANY_PAYLOAD_SIZES[type] < count) return nullptr;
+        return pos;
+    }
+
+    std::span<std::byte const> m_data;
+    bool m_headerValid = false;
+};
+
+using AnyReader = BasicAnyReader<AnyLayout::Wide>;
@@ -0,0 +1,234 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "AnyType.hpp"
+
+// Column of AnyType values stored as a struct of arrays: one tag byte and one 8-byte slot per value.
+// Signed integers are stored sign-extended to 64 bits, unsigned ones and bool zero-extended,
+// float and double as double, and long double in a side array whose index is kept in the slot.
+// Batch operations walk the column run by run, where a run is a sequence of values with the same
+// tag, so the inner loops are branch-free and vectorizable.
+class AnyColumn {
+public:
+    using Type = AnyType::Type;
+
+    AnyColumn() noexcept = default;
+
+    [[nodiscard]] std::size_t size() const noexcept { return m_types.size(); }
+    [[nodiscard]] bool empty() const noexcept { return m_types.empty(); }
+
+    void reserve(std::size_t capacity) {
+        m_types.reserve(capacity);
+        m_slots.reserve(capacity);
+    }
+
+    void clear() noexcept {
+        m_types.clear();
+        m_slots.clear();
+        m_wide.clear();
+    }
+
+    template <typename T> requires std::is_arithmetic_v<T>
+    void push_back(T value) {
+        m_types.push_back(AnyType::type_of<T>());
+        m_slots.push_back(encode(value));
+    }
+
+    void push_back(AnyType const& value) {
+        dispatch(value.type(), [&]<typename T>(std::type_identity<T>) { push_back(*value.try_get<T>()); });
+    }
+
+    // appends a whole run of one type at once
+    template <typename T> requires std::is_arithmetic_v<T>
+    void append(std::span<T const> values) {
+        m_types.insert(m_types.end(), values.size(), AnyType::type_of<T>());
+        m_slots.reserve(m_slots.size() + values.size());
+        for (auto value : values) m_slots.push_back(encode(value));
+    }
+
+    void append(std::span<AnyType const> values) {
+        reserve(size() + values.size());
+        for (auto const& value : values) push_back(value);
+    }
+
+    [[nodiscard]] Type type(std::size_t index) const noexcept { return m_types[index]; }
+
+    [[nodiscard]] AnyType operator[](std::size_t index) const noexcept {
+        return dispatch(m_types[index], [&]<typename T>(std::type_identity<T>) {
+            return AnyType(decode<T>(m_slots[index]));
+        });
+    }
+
+    // sum of all values converted to double
+    [[nodiscard]] double sum() const noexcept {
+        double total = 0;
+        forEachRun([&](Type type, std::size_t begin, std::size_t end) {
+            total += dispatchStorage(type, [&]<typename S>(std::type_identity<S>) {
+                return sumRun<S>(begin, end);
+            });
+        });
+        return total;
+    }
+
+    // smallest and largest value converted to double, nullopt for an empty column;
+    // runs are reduced in their own storage type, so integers compare exactly within a run
+    [[nodiscard]] std::optional<double> min() const noexcept { return reduce<false>(); }
+    [[nodiscard]] std::optional<double> max() const noexcept { return reduce<true>(); }
+
+    // converts every value to double, out must hold size() values
+    void to_double(std::span<double> out) const noexcept {
+        forEachRun([&](Type type, std::size_t begin, std::size_t end) {
+            dispatchStorage(type, [&]<typename S>(std::type_identity<S>) {
+                for (std::size_t i = begin; i < end; ++i) out[i] = static_cast<double>(load<S>(i));
+            });
+        });
+    }
+
+    [[nodiscard]] std::vector<double> to_double() const {
+        std::vector<double> out(size());
+        to_double(out);
+        return out;
+    }
+
+    [[nodiscard]] std::size_t count(Type type) const noexcept {
+        return static_cast<std::size_t>(std::count(m_types.begin(), m_types.end(), type));
+    }
+
+    // all values of type T, in column order
+    template <typename T> requires std::is_arithmetic_v<T>
+    [[nodiscard]] std::vector<T> filter() const {
+        constexpr auto wanted = AnyType::type_of<T>();
+        std::vector<T> out;
+        out.reserve(count(wanted));
+        forEachRun([&](Type type, std::size_t begin, std::size_t end) {
+            if (type != wanted) return;
+            for (std::size_t i = begin; i < end; ++i) out.push_back(decode<T>(m_slots[i]));
+        });
+        return out;
+    }
+
+private:
+    // number of independent accumulators, enough to fill a 256-bit vector of 64-bit lanes
+    static constexpr std::size_t LANES = 4;
+
+    template <typename F>
+    static std::invoke_result_t<F, std::type_identity<bool>> dispatch(Type type, F&& f) {
+        switch (type) {
+            case Type::Bool: return f(std::type_identity<bool>{});
+            case Type::Char: return f(std::type_identity<char>{});
+            case Type::UChar: return f(std::type_identity<unsigned char>{});
+            case Type::Short: return f(std::type_identity<short>{});
+            case Type::UShort: return f(std::type_identity<unsigned short>{});
+            case Type::Int: return f(std::type_identity<int>{});
+            case Type::UInt: return f(std::type_identity<unsigned int>{});
+            case Type::Long: return f(std::type_identity<long>{});
+            case Type::ULong: return f(std::type_identity<unsigned long>{});
+            case Type::LongLong: return f(std::type_identity<long long>{});
+            case Type::ULongLong: return f(std::type_identity<unsigned long long>{});
+            case Type::Float: return f(std::type_identity<float>{});
+            case Type::Double: return f(std::type_identity<double>{});
+            case Type::LongDouble: return f(std::type_identity<long double>{});
+        }
+        std::unreachable();
+    }
+
+    // type a value is kept as in its slot: std::int64_t, std::uint64_t, double or long double
+    template <typename T>
+    using Storage = std::conditional_t<std::is_floating_point_v<T>,
+        std::conditional_t<std::is_same_v<T, long double>, long double, double>,
+        std::conditional_t<std::is_signed_v<T>, std::int64_t, std::uint64_t>>;
+
+    template <typename F>
+    static std::invoke_result_t<F, std::type_identity<std::uint64_t>> dispatchStorage(Type type, F&& f) {
+        return dispatch(type, [&]<typename T>(std::type_identity<T>) {
+            return f(std::type_identity<Storage<T>>{});
+        });
+    }
+
+    template <typename T>
+    std::uint64_t encode(T value) {
+        using S = Storage<T>;
+        if constexpr (std::is_same_v<S, long double>) {
+            m_wide.push_back(value);
+            return m_wide.size() - 1;
+        } else if constexpr (std::is_same_v<S, double>) {
+            return std::bit_cast<std::uint64_t>(static_cast<double>(value));
+        } else {
+            return static_cast<std::uint64_t>(static_cast<S>(value));
+        }
+    }
+
+    template <typename T>
+    T decode(std::uint64_t slot) const noexcept {
+        using S = Storage<T>;
+        if constexpr (std::is_same_v<S, long double>) return m_wide[slot];
+        else if constexpr (std::is_same_v<S, double>) return static_cast<T>(std::bit_cast<double>(slot));
+        else return static_cast<T>(static_cast<S>(slot));
+    }
+
+    template <typename S>
+    S load(std::size_t index) const noexcept {
+        if constexpr (std::is_same_v<S, long double>) return m_wide[m_slots[index]];
+        else if constexpr (std::is_same_v<S, double>) return std::bit_cast<double>(m_slots[index]);
+        else return static_cast<S>(m_slots[index]);
+    }
+
+    template <typename F>
+    void forEachRun(F&& f) const {
+        std::size_t const n = m_types.size();
+        for (std::size_t begin = 0; begin < n;) {
+            auto const type = m_types[begin];
+            std::size_t end = begin + 1;
+            while (end < n && m_types[end] == type) ++end;
+            f(type, begin, end);
+            begin = end;
+        }
+    }
+
+    template <typename S>
+    double sumRun(std::size_t begin, std::size_t end) const noexcept {
+        double lanes[LANES] = {};
+        std::size_t i = begin;
+        for (; i + LANES <= end; i += LANES) {
+            for (std::size_t lane = 0; lane < LANES; ++lane) lanes[lane] += static_cast<double>(load<S>(i + lane));
+        }
+        for (; i < end; ++i) lanes[0] += static_cast<double>(load<S>(i));
+        return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+
+    template <bool Max, typename S>
+    S reduceRun(std::size_t begin, std::size_t end) const noexcept {
+        auto better = [](S a, S b) { return Max ? (b > a ? b : a) : (b < a ? b : a); };
+        S lanes[LANES];
+        for (auto& lane : lanes) lane = load<S>(begin);
+        std::size_t i = begin;
+        for (; i + LANES <= end; i += LANES) {
+            for (std::size_t lane = 0; lane < LANES; ++lane) lanes[lane] = better(lanes[lane], load<S>(i + lane));
+        }
+        for (; i < end; ++i) lanes[0] = better(lanes[0], load<S>(i));
+        return better(better(lanes[0], lanes[1]), better(lanes[2], lanes[3]));
+    }
+
+    template <bool Max>
+    std::optional<double> reduce() const noexcept {
+        std::optional<double> result;
+        forEachRun([&](Type type, std::size_t begin, std::size_t end) {
+            double value = dispatchStorage(type, [&]<typename S>(std::type_identity<S>) {
+                return static_cast<double>(reduceRun<Max, S>(begin, end));
+            });
+            if (!result || (Max ? value > *result : value < *result)) result = value;
+        });
+        return result;
+    }
+
+    std::vector<Type> m_types;
+    std::vector<std::uint64_t> m_slots;
+    std::vector<long double> m_wide;
+};
@@ -1,12 +1,39 @@
 #pragma once
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
 #include <optional>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 #include <variant>
 
-class AnyType {
+namespace detail {
+    // the C++ type of every Type value, in the order of the enum
+    using AnyTypeList = std::tuple<bool, char, unsigned char, short, unsigned short, int, unsigned int, long,
+        unsigned long, long long, unsigned long long, float, double, long double>;
+
+    constexpr std::size_t ANY_TYPE_COUNT = std::tuple_size_v<AnyTypeList>;
+
+    template <std::size_t Index>
+    using AnyTypeAt = std::tuple_element_t<Index, AnyTypeList>;
+
+}
+
+// Type tags shared by every AnyType layout.
+class AnyTypeBase {
 public:
-    enum class Type {
+    enum class Type : std::uint8_t {
         Bool,
         Char,
         UChar,
@@ -43,60 +70,38 @@ public:
         std::unreachable();
     }
 
-    template <typename T> requires std::is_arithmetic_v<T>
-    T& as() noexcept {
-        if constexpr (std::is_same_v<T, bool>) return m_data.b;
-        if constexpr (std::is_same_v<T, char>) return m_data.c;
-        if constexpr (std::is_same_v<T, unsigned char>) return m_data.uc;
-        if constexpr (std::is_same_v<T, short>) return m_data.s;
-        if constexpr (std::is_same_v<T, unsigned short>) return m_data.us;
-        if constexpr (std::is_same_v<T, int>) return m_data.i;
-        if constexpr (std::is_same_v<T, unsigned int>) return m_data.ui;
-        if constexpr (std::is_same_v<T, long>) return m_data.l;
-        if constexpr (std::is_same_v<T, unsigned long>) return m_data.ul;
-        if constexpr (std::is_same_v<T, long long>) return m_data.ll;
-        if constexpr (std::is_same_v<T, unsigned long long>) return m_data.ull;
-        if constexpr (std::is_same_v<T, float>) return m_data.f;
-        if constexpr (std::is_same_v<T, double>) return m_data.d;
-        if constexpr (std::is_same_v<T, long double>) return m_data.ld;
+    // type of the result of a binary arithmetic operator on values of types a and b,
+    // following the usual arithmetic conversions
+    [[nodiscard]] static constexpr Type promoted(Type a, Type b) noexcept;
+};
 
-        std::unreachable();
-    }
+namespace detail {
+    constexpr auto ANY_PROMOTIONS = []<std::size_t... Flat>(std::index_sequence<Flat...>) {
+        std::array<std::array<AnyTypeBase::Type, ANY_TYPE_COUNT>, ANY_TYPE_COUNT> table{};
+        ((table[Flat / ANY_TYPE_COUNT][Flat % ANY_TYPE_COUNT] = AnyTypeBase::type_of<
+            decltype(AnyTypeAt<Flat / ANY_TYPE_COUNT>{} + AnyTypeAt<Flat % ANY_TYPE_COUNT>{})>()), ...);
+        return table;
+    }(std::make_index_sequence<ANY_TYPE_COUNT * ANY_TYPE_COUNT>{});
+}
 
-    template <typename T> requires std::is_arithmetic_v<T>
-    explicit(false) AnyType(T value) noexcept : m_type(type_of<T>()) { as<T>() = value; }
+constexpr AnyTypeBase::Type AnyTypeBase::promoted(Type a, Type b) noexcept {
+    return detail::ANY_PROMOTIONS[static_cast<std::size_t>(a)][static_cast<std::size_t>(b)];
+}
 
-    AnyType(AnyType const& other) noexcept = default;
-    AnyType(AnyType&& other) noexcept = default;
-    AnyType& operator=(AnyType const& other) noexcept = default;
-    AnyType& operator=(AnyType&& other) noexcept = default;
+// Memory layouts of AnyType:
+//   Wide      every fundamental type, 32 bytes on x86-64 because of long double
+//   Compact   every fundamental type except long double, 16 bytes
+//   NanBoxed  bool, int and double only, packed into a single 8-byte double
+enum class AnyLayout {
+    Wide,
+    Compact,
+    NanBoxed,
+};
 
-    [[nodiscard]] Type type() const noexcept { return m_type; }
+namespace detail {
+    struct AnyAccess;
 
-    template <typename T> requires std::is_arithmetic_v<T>
-    [[nodiscard]] bool is() const noexcept {
-        return m_type == type_of<T>();
-    }
-
-    void swap(AnyType& other) noexcept {
-        std::swap(m_data, other.m_data);
-        std::swap(m_type, other.m_type);
-    }
-
-    template <typename T> requires std::is_arithmetic_v<T>
-    [[nodiscard]] T get() const {
-        if (!is<T>()) throw std::bad_variant_access();
-        return const_cast<AnyType*>(this)->as<T>();
-    }
-
-    template <typename T> requires std::is_arithmetic_v<T>
-    [[nodiscard]] std::optional<T> try_get() const noexcept {
-        if (!is<T>()) return std::nullopt;
-        return const_cast<AnyType*>(this)->as<T>();
-    }
-
-private:
-    union {
+    union AnyWideData {
         bool b;
         char c;
         unsigned char uc;
@@ -111,6 +116,546 @@ private:
         float f;
         double d;
         long double ld;
-    } m_data{};
-    Type m_type{};
-};
\ No newline at end of file
+    };
+
+    union AnyCompactData {
+        bool b;
+        char c;
+        unsigned char uc;
+        short s;
+        unsigned short us;
+        int i;
+        unsigned int ui;
+        long l;
+        unsigned long ul;
+        long long ll;
+        unsigned long long ull;
+        float f;
+        double d;
+    };
+
+    // value union next to a type tag, the members are addressable so as<T>() can hand out references
+    template <typename Data>
+    class AnyUnionStorage {
+    public:
+        using Type = AnyTypeBase::Type;
+
+        template <typename T>
+        static constexpr bool supports = std::is_arithmetic_v<T>
+            && (!std::is_same_v<T, long double> || requires(Data& data) { data.ld; });
+
+        template <typename T> requires supports<T>
+        constexpr explicit AnyUnionStorage(T value) noexcept : m_data(make(value)), m_type(AnyTypeBase::type_of<T>()) {}
+
+        [[nodiscard]] constexpr Type type() const noexcept { return m_type; }
+
+        template <typename T> requires supports<T>
+        constexpr T& as() noexcept {
+            if constexpr (std::is_same_v<T, bool>) return m_data.b;
+            if constexpr (std::is_same_v<T, char>) return m_data.c;
+            if constexpr (std::is_same_v<T, unsigned char>) return m_data.uc;
+            if constexpr (std::is_same_v<T, short>) return m_data.s;
+            if constexpr (std::is_same_v<T, unsigned short>) return m_data.us;
+            if constexpr (std::is_same_v<T, int>) return m_data.i;
+            if constexpr (std::is_same_v<T, unsigned int>) return m_data.ui;
+            if constexpr (std::is_same_v<T, long>) return m_data.l;
+            if constexpr (std::is_same_v<T, unsigned long>) return m_data.ul;
+            if constexpr (std::is_same_v<T, long long>) return m_data.ll;
+            if constexpr (std::is_same_v<T, unsigned long long>) return m_data.ull;
+            if constexpr (std::is_same_v<T, float>) return m_data.f;
+            if constexpr (std::is_same_v<T, double>) return m_data.d;
+            if constexpr (std::is_same_v<T, long double>) return m_data.ld;
+
+            std::unreachable();
+        }
+
+        template <typename T> requires supports<T>
+        [[nodiscard]] constexpr T load() const noexcept {
+            return const_cast<AnyUnionStorage*>(this)->as<T>();
+        }
+
+    private:
+        // initializes the member for T directly, constant evaluation cannot switch the active member through as<T>()
+        template <typename T>
+        static constexpr Data make(T value) noexcept {
+            if constexpr (std::is_same_v<T, bool>) return Data{.b = value};
+            if constexpr (std::is_same_v<T, char>) return Data{.c = value};
+            if constexpr (std::is_same_v<T, unsigned char>) return Data{.uc = value};
+            if constexpr (std::is_same_v<T, short>) return Data{.s = value};
+            if constexpr (std::is_same_v<T, unsigned short>) return Data{.us = value};
+            if constexpr (std::is_same_v<T, int>) return Data{.i = value};
+            if constexpr (std::is_same_v<T, unsigned int>) return Data{.ui = value};
+            if constexpr (std::is_same_v<T, long>) return Data{.l = value};
+            if constexpr (std::is_same_v<T, unsigned long>) return Data{.ul = value};
+            if constexpr (std::is_same_v<T, long long>) return Data{.ll = value};
+            if constexpr (std::is_same_v<T, unsigned long long>) return Data{.ull = value};
+            if constexpr (std::is_same_v<T, float>) return Data{.f = value};
+            if constexpr (std::is_same_v<T, double>) return Data{.d = value};
+            if constexpr (std::is_same_v<T, long double>) return Data{.ld = value};
+
+            std::unreachable();
+        }
+
+        Data m_data{};
+        Type m_type{};
+    };
+
+    // A double whose NaN space carries the other types: a value whose top 16 bits are above 0xFFF8
+    // is not a double but a boxed value, with the tag in bits 48..50 and the payload in the low 32 bits.
+    // Doubles that would fall into that range are NaNs, they are stored as the canonical quiet NaN.
+    class AnyNanBoxedStorage {
+    public:
+        using Type = AnyTypeBase::Type;
+
+        template <typename T>
+        static constexpr bool supports = std::is_same_v<T, bool> || std::is_same_v<T, int> || std::is_same_v<T, double>;
+
+        template <typename T> requires supports<T>
+        constexpr explicit AnyNanBoxedStorage(T value) noexcept : m_bits(encode(value)) {}
+
+        [[nodiscard]] constexpr Type type() const noexcept {
+            switch (m_bits >> TAG_SHIFT) {
+                case BOX_TOP + BOOL_TAG: return Type::Bool;
+                case BOX_TOP + INT_TAG: return Type::Int;
+                default: return Type::Double;
+            }
+        }
+
+        template <typename T> requires supports<T>
+        [[nodiscard]] constexpr T load() const noexcept {
+            if constexpr (std::is_same_v<T, double>) return std::bit_cast<double>(m_bits);
+            else return static_cast<T>(static_cast<std::int32_t>(static_cast<std::uint32_t>(m_bits)));
+        }
+
+    private:
+        static constexpr int TAG_SHIFT = 48;
+        static constexpr std::uint64_t BOX_TOP = 0xFFF8;
+        static constexpr std::uint64_t BOOL_TAG = 1;
+        static constexpr std::uint64_t INT_TAG = 2;
+        static constexpr std::uint64_t CANONICAL_NAN = 0x7FF8'0000'0000'0000;
+
+        template <typename T>
+        static constexpr std::uint64_t encode(T value) noexcept {
+            if constexpr (std::is_same_v<T, double>) {
+                auto bits = std::bit_cast<std::uint64_t>(value);
+                return bits >> TAG_SHIFT > BOX_TOP ? CANONICAL_NAN : bits;
+            } else {
+                constexpr auto tag = std::is_same_v<T, bool> ? BOOL_TAG : INT_TAG;
+                return (BOX_TOP + tag) << TAG_SHIFT | static_cast<std::uint32_t>(value);
+            }
+        }
+
+        std::uint64_t m_bits;
+    };
+
+    template <AnyLayout Layout>
+    using AnyStorage = std::conditional_t<Layout == AnyLayout::Wide, AnyUnionStorage<AnyWideData>,
+        std::conditional_t<Layout == AnyLayout::Compact, AnyUnionStorage<AnyCompactData>, AnyNanBoxedStorage>>;
+
+    // integers widened to 64 bits keeping their signedness, floating-point values unchanged
+    template <typename T>
+    constexpr auto anyWiden(T value) noexcept {
+        if constexpr (std::is_floating_point_v<T>) return value;
+        else if constexpr (std::is_signed_v<T>) return static_cast<long long>(value);
+        else return static_cast<unsigned long long>(value);
+    }
+
+    // 2^digits of the integer type, the first value above its range
+    template <typename F, typename I>
+    constexpr F anyIntegerEnd = static_cast<F>(std::numeric_limits<I>::max() / 2 + 1) * 2;
+
+    // exact comparison of a 64-bit integer with a floating-point value
+    template <typename I, typename F>
+    constexpr std::partial_ordering anyCompareMixed(I integer, F real) noexcept {
+        constexpr F upper = anyIntegerEnd<F, I>;
+        constexpr F lower = std::is_signed_v<I> ? -upper : F(0);
+        if (real != real) return std::partial_ordering::unordered;
+        if (real < lower) return std::partial_ordering::greater;
+        if (real >= upper) return std::partial_ordering::less;
+
+        // whole is exact in F: either it is small enough, or real has no fractional part anyway
+        auto whole = static_cast<I>(real);
+        if (integer != whole) return integer < whole ? std::partial_ordering::less : std::partial_ordering::greater;
+        return static_cast<F>(whole) <=> real;
+    }
+
+    // compares the values mathematically, so that equal values also hash equally
+    template <typename A, typename B>
+    constexpr std::partial_ordering anyCompare(A a, B b) noexcept {
+        auto x = anyWiden(a);
+        auto y = anyWiden(b);
+        using X = decltype(x);
+        using Y = decltype(y);
+        if constexpr (std::is_integral_v<X> && std::is_integral_v<Y>) {
+            if (std::cmp_equal(x, y)) return std::partial_ordering::equivalent;
+            return std::cmp_less(x, y) ? std::partial_ordering::less : std::partial_ordering::greater;
+        } else if constexpr (std::is_integral_v<X>) {
+            return anyCompareMixed(x, y);
+        } else if constexpr (std::is_integral_v<Y>) {
+            return 0 <=> anyCompareMixed(y, x);
+        } else {
+            return x <=> y;
+        }
+    }
+
+    // integral values hash like the integer they are equal to, whatever their type
+    template <typename T>
+    std::size_t anyHash(T value) noexcept {
+        auto x = anyWiden(value);
+        using X = decltype(x);
+        if constexpr (std::is_integral_v<X>) {
+            if constexpr (std::is_unsigned_v<X>) {
+                if (x > static_cast<X>(std::numeric_limits<long long>::max())) return std::hash<X>{}(x);
+            }
+            return std::hash<long long>{}(static_cast<long long>(x));
+        } else {
+            if (x == std::trunc(x)) {
+                if (x >= -anyIntegerEnd<X, long long> && x < anyIntegerEnd<X, long long>) {
+                    return anyHash(static_cast<long long>(x));
+                }
+                if (x >= 0 && x < anyIntegerEnd<X, unsigned long long>) return anyHash(static_cast<unsigned long long>(x));
+            }
+            if constexpr (std::is_same_v<X, long double>) {
+                if (static_cast<double>(x) == x) return std::hash<double>{}(static_cast<double>(x));
+                return std::hash<long double>{}(x);
+            } else {
+                return std::hash<double>{}(x);
+            }
+        }
+    }
+
+    // checks eight bytes at a time that the text consists of decimal digits only
+    inline bool anyIsDigits(std::string_view text) noexcept {
+        std::size_t i = 0;
+        for (; i + 8 <= text.size(); i += 8) {
+            std::uint64_t word;
+            std::memcpy(&word, text.data() + i, sizeof(word));
+            // a byte is a digit if neither adding 0x46 nor subtracting 0x30 sets its top bit
+            if (((word + 0x4646'4646'4646'4646) | (word - 0x3030'3030'3030'3030)) & 0x8080'8080'8080'8080) return false;
+        }
+        for (; i < text.size(); ++i) {
+            if (text[i] < '0' || text[i] > '9') return false;
+        }
+        return true;
+    }
+
+    template <typename Any, typename T, typename... Rest>
+    std::optional<Any> anyNarrowestInteger(long long value) noexcept {
+        if constexpr (Any::template supports<T>) {
+            if (std::in_range<T>(value)) return Any(static_cast<T>(value));
+        }
+        if constexpr (sizeof...(Rest) > 0) return anyNarrowestInteger<Any, Rest...>(value);
+        else return std::nullopt;
+    }
+
+    template <typename Any>
+    std::optional<Any> anyParseInteger(std::string_view text) noexcept {
+        auto first = text.data();
+        auto last = text.data() + text.size();
+        long long value;
+        auto [end, error] = std::from_chars(first, last, value);
+        if (error == std::errc{} && end == last) return anyNarrowestInteger<Any, short, int, long long>(value);
+
+        if constexpr (Any::template supports<unsigned long long>) {
+            unsigned long long big;
+            auto [bigEnd, bigError] = std::from_chars(first, last, big);
+            if (bigError == std::errc{} && bigEnd == last) return Any(big);
+        }
+        return std::nullopt;
+    }
+
+    // number of significant digits of a decimal floating-point number
+    inline std::size_t anySignificantDigits(std::string_view text) noexcept {
+        std::size_t digits = 0;
+        bool leading = true;
+        for (char c : text) {
+            if (c == 'e' || c == 'E') break;
+            if (c < '0' || c > '9') continue;
+            if (leading && c == '0') continue;
+            leading = false;
+            ++digits;
+        }
+        return digits;
+    }
+
+    template <typename Any>
+    std::optional<Any> anyParseReal(std::string_view text) noexcept {
+        auto first = text.data();
+        auto last = text.data() + text.size();
+        double value;
+        auto [end, error] = std::from_chars(first, last, value);
+        if (error != std::errc{} || end != last) return std::nullopt;
+
+        // a float reproduces every decimal of up to digits10 significant digits within its normal range
+        if constexpr (Any::template supports<float>) {
+            auto magnitude = std::abs(value);
+            bool inRange = magnitude == 0
+                || (magnitude >= std::numeric_limits<float>::min() && magnitude <= std::numeric_limits<float>::max());
+            if (inRange && anySignificantDigits(text) <= std::numeric_limits<float>::digits10) {
+                float narrow;
+                std::from_chars(first, last, narrow);
+                return Any(narrow);
+            }
+        }
+        return Any(value);
+    }
+
+    template <typename Any>
+    std::optional<Any> anyParse(std::string_view text) noexcept {
+        if (text.empty()) return std::nullopt;
+        if (text == "true") return Any(true);
+        if (text == "false") return Any(false);
+
+        auto digits = text.front() == '-' ? text.substr(1) : text;
+        // an integer no type holds exactly is not rounded to a real
+        if (!digits.empty() && anyIsDigits(digits)) return anyParseInteger<Any>(text);
+        return anyParseReal<Any>(text);
+    }
+}
+
+template <AnyLayout Layout = AnyLayout::Wide>
+class BasicAnyType : public AnyTypeBase {
+    using Storage = detail::AnyStorage<Layout>;
+    friend struct detail::AnyAccess;
+
+public:
+    // whether values of type T can be stored in this layout
+    template <typename T>
+    static constexpr bool supports = Storage::template supports<T>;
+
+    template <typename T> requires std::is_arithmetic_v<T> && supports<T> && (Layout != AnyLayout::NanBoxed)
+    constexpr T& as() noexcept {
+        return m_storage.template as<T>();
+    }
+
+    template <typename T> requires std::is_arithmetic_v<T> && supports<T>
+    constexpr explicit(false) BasicAnyType(T value) noexcept : m_storage(value) {}
+
+    constexpr BasicAnyType(BasicAnyType const& other) noexcept = default;
+    constexpr BasicAnyType(BasicAnyType&& other) noexcept = default;
+    constexpr BasicAnyType& operator=(BasicAnyType const& other) noexcept = default;
+    constexpr BasicAnyType& operator=(BasicAnyType&& other) noexcept = default;
+
+    [[nodiscard]] constexpr Type type() const noexcept { return m_storage.type(); }
+
+    template <typename T> requires std::is_arithmetic_v<T>
+    [[nodiscard]] constexpr bool is() const noexcept {
+        if constexpr (!supports<T>) return false;
+        else return type() == type_of<T>();
+    }
+
+    constexpr void swap(BasicAnyType& other) noexcept {
+        std::swap(m_storage, other.m_storage);
+    }
+
+    template <typename T> requires std::is_arithmetic_v<T> && supports<T>
+    [[nodiscard]] constexpr T get() const {
+        if (!is<T>()) throw std::bad_variant_access();
+        return m_storage.template load<T>();
+    }
+
+    template <typename T> requires std::is_arithmetic_v<T> && supports<T>
+    [[nodiscard]] constexpr std::optional<T> try_get() const noexcept {
+        if (!is<T>()) return std::nullopt;
+        return m_storage.template load<T>();
+    }
+
+    // Parses text into the narrowest type that holds the value exactly: true/false as bool,
+    // integers as short, int, long long or unsigned long long, other numbers as float if they
+    // have at most 6 significant digits and double otherwise. Types the layout cannot hold are
+    // skipped. Returns nullopt if the whole text is not a number, or is an integer that no type
+    // the layout holds can store exactly.
+    [[nodiscard]] static std::optional<BasicAnyType> parse(std::string_view text) noexcept {
+        return detail::anyParse<BasicAnyType>(text);
+    }
+
+    // Parses the fields of a delimited line into out, without allocating. Returns the number of
+    // fields stored, which stops short at the first field that does not parse or when out is full.
+    static std::size_t parse_line(std::string_view line, char delimiter, std::span<BasicAnyType> out) noexcept {
+        std::size_t count = 0;
+        while (count < out.size()) {
+            auto end = line.find(delimiter);
+            auto value = parse(line.substr(0, end));
+            if (!value) break;
+            out[count++] = *value;
+            if (end == std::string_view::npos) break;
+            line.remove_prefix(end + 1);
+        }
+        return count;
+    }
+
+    // Arithmetic follows the usual arithmetic conversions, the result has the type given by
+    // promoted(a.type(), b.type()). Only integer division by zero throws std::domain_error.
+    friend constexpr BasicAnyType operator+(BasicAnyType const& a, BasicAnyType const& b) noexcept {
+        return visit([](auto x, auto y) { return BasicAnyType(x + y); }, a, b);
+    }
+
+    friend constexpr BasicAnyType operator-(BasicAnyType const& a, BasicAnyType const& b) noexcept {
+        return visit([](auto x, auto y) { return BasicAnyType(x - y); }, a, b);
+    }
+
+    friend constexpr BasicAnyType operator*(BasicAnyType const& a, BasicAnyType const& b) noexcept {
+        return visit([](auto x, auto y) { return BasicAnyType(x * y); }, a, b);
+    }
+
+    friend constexpr BasicAnyType operator/(BasicAnyType const& a, BasicAnyType const& b) {
+        return visit([](auto x, auto y) {
+            if constexpr (std::is_integral_v<decltype(x / y)>) {
+                if (y == 0) throw std::domain_error("AnyType: integer division by zero");
+            }
+            return BasicAnyType(x / y);
+        }, a, b);
+    }
+
+    // Comparisons are exact across all types, unlike the built-in operators: -1 < 1u,
+    // and 16777217 != 16777216.0f. NaN is unordered with everything.
+    friend constexpr std::partial_ordering operator<=>(BasicAnyType const& a, BasicAnyType const& b) noexcept {
+        return visit([](auto x, auto y) { return detail::anyCompare(x, y); }, a, b);
+    }
+
+    friend constexpr bool operator==(BasicAnyType const& a, BasicAnyType const& b) noexcept {
+        return (a <=> b) == 0;
+    }
+
+private:
+    Storage m_storage;
+};
+
+using AnyType = BasicAnyType<AnyLayout::Wide>;
+using CompactAnyType = BasicAnyType<AnyLayout::Compact>;
+using NanBoxedAnyType = BasicAnyType<AnyLayout::NanBoxed>;
+
+namespace detail {
+    template <typename T>
+    constexpr bool isAnyType = false;
+
+    template <AnyLayout Layout>
+    constexpr bool isAnyType<BasicAnyType<Layout>> = true;
+
+    struct AnyAccess {
+        // unchecked access for a type already known to be stored: a reference for mutable
+        // lvalues of layouts with addressable storage, a copy of the value otherwise
+        template <typename T, typename Any>
+        static constexpr decltype(auto) get(Any&& any) noexcept {
+            constexpr bool mutableLvalue = std::is_lvalue_reference_v<Any> && !std::is_const_v<std::remove_reference_t<Any>>;
+            if constexpr (mutableLvalue && requires { any.template as<T>(); }) return any.template as<T>();
+            else return any.m_storage.template load<T>();
+        }
+    };
+
+    // The payload of a value is the bytes that carry it: sizeof(T), except for long double,
+    // whose x87 80-bit format is padded to 16 bytes with undefined contents.
+    constexpr std::size_t ANY_LONG_DOUBLE_BYTES = std::numeric_limits<long double>::digits == 64 ? 10 : sizeof(long double);
+
+    template <typename T>
+    constexpr std::size_t anyPayloadSize = std::is_same_v<T, long double> ? ANY_LONG_DOUBLE_BYTES : sizeof(T);
+
+    constexpr auto ANY_PAYLOAD_SIZES = []<std::size_t... Index>(std::index_sequence<Index...>) {
+        return std::array<std::size_t, ANY_TYPE_COUNT>{anyPayloadSize<AnyTypeAt<Index>>...};
+    }(std::make_index_sequence<ANY_TYPE_COUNT>{});
+
+    template <typename Any, typename T>
+    Any anyLoadPayload(std::byte const* payload) noexcept {
+        if constexpr (std::is_same_v<T, bool>) {
+            return Any(*payload != std::byte{0});
+        } else {
+            T value{};
+            std::memcpy(&value, payload, anyPayloadSize<T>);
+            return Any(value);
+        }
+    }
+
+    // payload decoder per Type, nullptr for types the layout cannot hold
+    template <typename Any>
+    constexpr auto ANY_LOADERS = []<std::size_t... Index>(std::index_sequence<Index...>) {
+        return std::array<Any (*)(std::byte const*), ANY_TYPE_COUNT>{[] {
+            using T = AnyTypeAt<Index>;
+            if constexpr (Any::template supports<T>) return &anyLoadPayload<Any, T>;
+            else return static_cast<Any (*)(std::byte const*)>(nullptr);
+        }()...};
+    }(std::make_index_sequence<ANY_TYPE_COUNT>{});
+
+    template <typename T, typename Any>
+    using AnyAccessResult = decltype(AnyAccess::get<T>(std::declval<Any>()));
+
+    // index of one argument's type within the flattened index of a type combination
+    template <std::size_t Flat, std::size_t Arg, std::size_t Args>
+    constexpr std::size_t anyTypeDigit() {
+        std::size_t flat = Flat;
+        for (std::size_t i = Arg + 1; i < Args; ++i) flat /= ANY_TYPE_COUNT;
+        return flat % ANY_TYPE_COUNT;
+    }
+
+    // table entry for one combination of stored types; combinations a layout cannot hold are never called
+    template <typename R, std::size_t Flat, typename F, typename... Any>
+    constexpr R anyVisitEntry(F&& f, Any&&... any) {
+        return [&]<std::size_t... Arg>(std::index_sequence<Arg...>) -> R {
+            constexpr std::size_t args = sizeof...(Any);
+            if constexpr ((std::remove_cvref_t<Any>::template supports<AnyTypeAt<anyTypeDigit<Flat, Arg, args>()>> && ...)) {
+                return std::invoke(std::forward<F>(f),
+                    AnyAccess::get<AnyTypeAt<anyTypeDigit<Flat, Arg, args>()>>(std::forward<Any>(any))...);
+            } else {
+                std::unreachable();
+            }
+        }(std::index_sequence_for<Any...>{});
+    }
+
+    template <typename R, typename F, typename... Any, std::size_t... Flat>
+    consteval auto makeAnyVisitTable(std::index_sequence<Flat...>) {
+        return std::array<R (*)(F&&, Any&&...), sizeof...(Flat)>{&anyVisitEntry<R, Flat, F, Any...>...};
+    }
+
+    consteval std::size_t anyCombinations(std::size_t args) {
+        std::size_t combinations = 1;
+        for (std::size_t i = 0; i < args; ++i) combinations *= ANY_TYPE_COUNT;
+        return combinations;
+    }
+
+    template <typename R, typename F, typename... Any>
+    constexpr auto ANY_VISIT_TABLE = makeAnyVisitTable<R, F, Any...>(std::make_index_sequence<anyCombinations(sizeof...(Any))>{});
+}
+
+// Calls f with the values stored in all arguments, f(a.get<A>(), b.get<B>(), ...), for the
+// actual stored types A, B, ... The type combination selects an entry of a table built at compile
+// time, so a call is a single indirect jump, without checks or exceptions. Mutable lvalues of the
+// Wide and Compact layouts are passed by reference, everything else by value. f must return the
+// same type for every combination. Every combination instantiates f, so with more than two
+// arguments the table grows quickly (14^n entries).
+template <typename F, typename... Any> requires (sizeof...(Any) > 0 && (detail::isAnyType<std::remove_cvref_t<Any>> && ...))
+constexpr decltype(auto) visit(F&& f, Any&&... any) {
+    using R = std::invoke_result_t<F, detail::AnyAccessResult<bool, Any>...>;
+    std::size_t index = 0;
+    ((index = index * detail::ANY_TYPE_COUNT + static_cast<std::size_t>(any.type())), ...);
+    return detail::ANY_VISIT_TABLE<R, F, Any...>[index](std::forward<F>(f), std::forward<Any>(any)...);
+}
+
+// Writes the value like std::to_chars, shortest round-trip form for floating-point values,
+// true/false for bool and the character itself for char. The output of numbers parses back with parse().
+template <AnyLayout Layout>
+std::to_chars_result to_chars(char* first, char* last, BasicAnyType<Layout> const& value) noexcept {
+    return visit([&](auto x) -> std::to_chars_result {
+        using T = decltype(x);
+        if constexpr (std::is_same_v<T, bool>) {
+            std::string_view text = x ? "true" : "false";
+            if (static_cast<std::size_t>(last - first) < text.size()) return {last, std::errc::value_too_large};
+            return {std::copy(text.begin(), text.end(), first), std::errc{}};
+        } else if constexpr (std::is_same_v<T, char>) {
+            if (first == last) return {last, std::errc::value_too_large};
+            *first = x;
+            return {first + 1, std::errc{}};
+        } else {
+            return std::to_chars(first, last, x);
+        }
+    }, value);
+}
+
+// Consistent with operator==: values that compare equal hash equally, so 1, 1u and 1.0 are the same key.
+template <AnyLayout Layout>
+struct std::hash<BasicAnyType<Layout>> {
+    std::size_t operator()(BasicAnyType<Layout> const& value) const noexcept {
+        return visit([](auto x) { return detail::anyHash(x); }, value);
+    }
+};
+
+static_assert(sizeof(CompactAnyType) <= 16);
+static_assert(sizeof(NanBoxedAnyType) == 8);
@@ -0,0 +1,15 @@
+#pragma once
+#include <format>
+#include <string_view>
+#include "AnyType.hpp"
+
+// std::format support, kept apart so that AnyType.hpp does not pull in <format>.
+// The value is written with to_chars(), the usual string format spec applies to the result: {:>12}.
+template <AnyLayout Layout>
+struct std::formatter<BasicAnyType<Layout>> : std::formatter<std::string_view> {
+    auto format(BasicAnyType<Layout> const& value, std::format_context& ctx) const {
+        char buffer[64];
+        auto [end, error] = to_chars(buffer, buffer + sizeof(buffer), value);
+        return std::formatter<std::string_view>::format(std::string_view(buffer, end), ctx);
+    }
+};
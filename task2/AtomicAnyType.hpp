@@ -0,0 +1,132 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include "AnyType.hpp"
+
+// AnyType that can be shared between threads without a mutex, built as a seqlock: the type and
+// the payload are kept in atomic words next to a sequence counter that is odd while a write is
+// in progress. Readers never write shared memory, they copy the words and retry if the counter
+// moved meanwhile, so any number of readers scale. Writers serialize by making the counter odd.
+// Every layout works the same way, long double just takes one more word.
+template <AnyLayout Layout = AnyLayout::Wide>
+class BasicAtomicAnyType {
+public:
+    using value_type = BasicAnyType<Layout>;
+
+    explicit BasicAtomicAnyType(value_type value) noexcept { write(encode(value)); }
+
+    BasicAtomicAnyType(BasicAtomicAnyType const&) = delete;
+    BasicAtomicAnyType& operator=(BasicAtomicAnyType const&) = delete;
+
+    [[nodiscard]] value_type load() const noexcept { return decode(read()); }
+
+    void store(value_type value) noexcept {
+        auto words = encode(value);
+        auto sequence = lock();
+        write(words);
+        unlock(sequence);
+    }
+
+    value_type exchange(value_type value) noexcept {
+        auto words = encode(value);
+        auto sequence = lock();
+        auto old = current();
+        write(words);
+        unlock(sequence);
+        return decode(old);
+    }
+
+    // Replaces the value with desired if it is bitwise identical to expected: same type and same
+    // payload, so 1 does not match 1.0 and a NaN matches itself. Otherwise loads the value into expected.
+    bool compare_exchange(value_type& expected, value_type desired) noexcept {
+        auto wanted = encode(expected);
+        auto sequence = lock();
+        auto old = current();
+        bool matches = old == wanted;
+        if (matches) write(encode(desired));
+        unlock(sequence);
+        if (!matches) expected = decode(old);
+        return matches;
+    }
+
+    // Adds delta like the compound assignment value += delta: the sum follows the usual
+    // arithmetic conversions and is converted back to the stored type. Returns the previous value.
+    value_type fetch_add(value_type delta) noexcept {
+        auto sequence = lock();
+        auto old = decode(current());
+        write(encode(visit([](auto x, auto y) { return value_type(static_cast<decltype(x)>(x + y)); }, old, delta)));
+        unlock(sequence);
+        return old;
+    }
+
+private:
+    // word 0 holds the type, the following words the payload, padded with zeros
+    static constexpr std::size_t PAYLOAD_BYTES = value_type::template supports<long double>
+        ? std::max(detail::anyPayloadSize<long double>, sizeof(std::uint64_t))
+        : sizeof(std::uint64_t);
+    static constexpr std::size_t WORDS = 1 + (PAYLOAD_BYTES + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+    using Words = std::array<std::uint64_t, WORDS>;
+
+    static Words encode(value_type const& value) noexcept {
+        Words words{};
+        words[0] = static_cast<std::uint64_t>(value.type());
+        visit([&](auto x) { std::memcpy(&words[1], &x, detail::anyPayloadSize<decltype(x)>); }, value);
+        return words;
+    }
+
+    static value_type decode(Words const& words) noexcept {
+        return detail::ANY_LOADERS<value_type>[words[0]](reinterpret_cast<std::byte const*>(&words[1]));
+    }
+
+    Words read() const noexcept {
+        for (;;) {
+            auto before = m_sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            Words words;
+            for (std::size_t i = 0; i < WORDS; ++i) words[i] = m_words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_sequence.load(std::memory_order_relaxed) == before) return words;
+        }
+    }
+
+    // the words as seen by the writer holding the lock
+    Words current() const noexcept {
+        Words words;
+        for (std::size_t i = 0; i < WORDS; ++i) words[i] = m_words[i].load(std::memory_order_relaxed);
+        return words;
+    }
+
+    void write(Words const& words) noexcept {
+        for (std::size_t i = 0; i < WORDS; ++i) m_words[i].store(words[i], std::memory_order_relaxed);
+    }
+
+    std::uint64_t lock() noexcept {
+        for (;;) {
+            auto sequence = m_sequence.load(std::memory_order_relaxed);
+            if (!(sequence & 1) && m_sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire)) {
+                // the odd counter must be visible before any of the new words
+                std::atomic_thread_fence(std::memory_order_release);
+                return sequence;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    void unlock(std::uint64_t sequence) noexcept {
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    std::atomic<std::uint64_t> m_sequence{0};
+    std::array<std::atomic<std::uint64_t>, WORDS> m_words{};
+};
+
+using AtomicAnyType = BasicAtomicAnyType<AnyLayout::Wide>;
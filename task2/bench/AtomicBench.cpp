@@ -0,0 +1,74 @@
+#include <mutex>
+#include <benchmark/benchmark.h>
+#include "AtomicAnyType.hpp"
+
+// Shared AnyType under contention: the seqlock-based AtomicAnyType against the same value behind
+// a mutex. Every thread works on one shared value, reads are 15 out of 16 operations in the mixed case.
+
+namespace {
+    class MutexAnyType {
+    public:
+        explicit MutexAnyType(AnyType value) noexcept : m_value(value) {}
+
+        AnyType load() const {
+            std::lock_guard lock(m_mutex);
+            return m_value;
+        }
+
+        void store(AnyType value) {
+            std::lock_guard lock(m_mutex);
+            m_value = value;
+        }
+
+        AnyType fetch_add(AnyType delta) {
+            std::lock_guard lock(m_mutex);
+            auto old = m_value;
+            m_value = visit([](auto x, auto y) { return AnyType(static_cast<decltype(x)>(x + y)); }, m_value, delta);
+            return old;
+        }
+
+    private:
+        mutable std::mutex m_mutex;
+        AnyType m_value;
+    };
+
+    AtomicAnyType sharedAtomic(0L);
+    MutexAnyType sharedMutex(0L);
+
+    template <typename Shared>
+    Shared& shared() {
+        if constexpr (std::is_same_v<Shared, AtomicAnyType>) return sharedAtomic;
+        else return sharedMutex;
+    }
+}
+
+template <typename Shared>
+static void BM_Load(benchmark::State& state) {
+    auto& value = shared<Shared>();
+    for (auto _ : state) benchmark::DoNotOptimize(value.load());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Load<AtomicAnyType>)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_Load<MutexAnyType>)->ThreadRange(1, 8)->UseRealTime();
+
+template <typename Shared>
+static void BM_FetchAdd(benchmark::State& state) {
+    auto& value = shared<Shared>();
+    for (auto _ : state) benchmark::DoNotOptimize(value.fetch_add(1L));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FetchAdd<AtomicAnyType>)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_FetchAdd<MutexAnyType>)->ThreadRange(1, 8)->UseRealTime();
+
+template <typename Shared>
+static void BM_Mixed(benchmark::State& state) {
+    auto& value = shared<Shared>();
+    unsigned step = 0;
+    for (auto _ : state) {
+        if (++step % 16 == 0) value.store(static_cast<double>(step));
+        else benchmark::DoNotOptimize(value.load());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Mixed<AtomicAnyType>)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_Mixed<MutexAnyType>)->ThreadRange(1, 8)->UseRealTime();
@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "AnyType.hpp"
+
+// Reads a vector of mixed int/double values in every layout, from L1-sized arrays up to main memory.
+// The work per value is the same, so the gap between the layouts is memory bandwidth and cache misses.
+
+namespace {
+    template <typename Any>
+    std::vector<Any> makeValues(size_t count) {
+        std::mt19937_64 rng(count);
+        std::uniform_int_distribution<int> integer(-1000, 1000);
+        std::uniform_real_distribution<double> real(-1000.0, 1000.0);
+        std::vector<Any> values;
+        values.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            if (rng() % 4 == 0) values.emplace_back(integer(rng));
+            else values.emplace_back(real(rng));
+        }
+        return values;
+    }
+
+    template <typename Any>
+    double valueOf(Any const& value) noexcept {
+        if (auto d = value.template try_get<double>()) return *d;
+        return *value.template try_get<int>();
+    }
+
+    void valueCounts(benchmark::internal::Benchmark* bench) {
+        bench->RangeMultiplier(8)->Range(1 << 9, 1 << 24)->ArgName("values");
+    }
+}
+
+template <typename Any>
+static void BM_SequentialSum(benchmark::State& state) {
+    auto const values = makeValues<Any>(state.range(0));
+    for (auto _ : state) {
+        double total = 0;
+        for (auto const& value : values) total += valueOf(value);
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(Any));
+    state.counters["sizeof"] = sizeof(Any);
+}
+BENCHMARK(BM_SequentialSum<AnyType>)->Apply(valueCounts);
+BENCHMARK(BM_SequentialSum<CompactAnyType>)->Apply(valueCounts);
+BENCHMARK(BM_SequentialSum<NanBoxedAnyType>)->Apply(valueCounts);
+
+// random order defeats the prefetcher, so every value costs a cache line (or a page) once the array outgrows the caches
+template <typename Any>
+static void BM_RandomSum(benchmark::State& state) {
+    auto const values = makeValues<Any>(state.range(0));
+    std::vector<unsigned> order(values.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::shuffle(order.begin(), order.end(), std::mt19937_64(values.size()));
+
+    for (auto _ : state) {
+        double total = 0;
+        for (auto index : order) total += valueOf(values[index]);
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["sizeof"] = sizeof(Any);
+}
+BENCHMARK(BM_RandomSum<AnyType>)->Apply(valueCounts);
+BENCHMARK(BM_RandomSum<CompactAnyType>)->Apply(valueCounts);
+BENCHMARK(BM_RandomSum<NanBoxedAnyType>)->Apply(valueCounts);
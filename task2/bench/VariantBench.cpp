@@ -0,0 +1,135 @@
+#include <any>
+#include <variant>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "AnyType.hpp"
+
+// AnyType against the standard alternatives holding the same 14 types: std::variant, which is
+// a tagged union as well, and std::any, which type-erases through a manager function.
+// Every benchmark works on VALUES elements, small enough to stay in cache, a mix of int and double
+// except for BM_Get, which reads back doubles only.
+
+namespace {
+    using Variant = std::variant<bool, char, unsigned char, short, unsigned short, int, unsigned int, long,
+        unsigned long, long long, unsigned long long, float, double, long double>;
+
+    constexpr size_t VALUES = 4096;
+
+    template <typename Holder>
+    Holder makeValue(size_t i) {
+        if (i % 4 == 0) return Holder(static_cast<int>(i));
+        return Holder(static_cast<double>(i) * 0.5);
+    }
+
+    template <typename Holder>
+    std::vector<Holder> makeValues() {
+        std::vector<Holder> values;
+        values.reserve(VALUES);
+        for (size_t i = 0; i < VALUES; ++i) values.push_back(makeValue<Holder>(i));
+        return values;
+    }
+
+    // checked access that throws on a type mismatch, like AnyType::get()
+    template <typename T>
+    T get(AnyType const& value) { return value.get<T>(); }
+
+    template <typename T>
+    T get(Variant const& value) { return std::get<T>(value); }
+
+    template <typename T>
+    T get(std::any const& value) { return std::any_cast<T>(value); }
+
+    double toDouble(AnyType const& value) {
+        return visit([](auto x) { return static_cast<double>(x); }, value);
+    }
+
+    double toDouble(Variant const& value) {
+        return std::visit([](auto x) { return static_cast<double>(x); }, value);
+    }
+
+    // std::any has no visitation, the caller has to try every type
+    template <typename T, typename... Rest>
+    double anyToDouble(std::any const& value) {
+        if (auto ptr = std::any_cast<T>(&value)) return static_cast<double>(*ptr);
+        if constexpr (sizeof...(Rest) > 0) return anyToDouble<Rest...>(value);
+        else return 0;
+    }
+
+    double toDouble(std::any const& value) {
+        return anyToDouble<bool, char, unsigned char, short, unsigned short, int, unsigned int, long,
+            unsigned long, long long, unsigned long long, float, double, long double>(value);
+    }
+}
+
+template <typename Holder>
+static void BM_Construct(benchmark::State& state) {
+    std::vector<Holder> values;
+    values.reserve(VALUES);
+    for (auto _ : state) {
+        values.clear();
+        for (size_t i = 0; i < VALUES; ++i) values.push_back(makeValue<Holder>(i));
+        benchmark::DoNotOptimize(values.data());
+    }
+    state.SetItemsProcessed(state.iterations() * VALUES);
+}
+BENCHMARK(BM_Construct<AnyType>);
+BENCHMARK(BM_Construct<Variant>);
+BENCHMARK(BM_Construct<std::any>);
+
+template <typename Holder>
+static void BM_Copy(benchmark::State& state) {
+    auto const values = makeValues<Holder>();
+    std::vector<Holder> copy;
+    copy.reserve(VALUES);
+    for (auto _ : state) {
+        copy.assign(values.begin(), values.end());
+        benchmark::DoNotOptimize(copy.data());
+    }
+    state.SetItemsProcessed(state.iterations() * VALUES);
+}
+BENCHMARK(BM_Copy<AnyType>);
+BENCHMARK(BM_Copy<Variant>);
+BENCHMARK(BM_Copy<std::any>);
+
+template <typename Holder>
+static void BM_Swap(benchmark::State& state) {
+    auto values = makeValues<Holder>();
+    for (auto _ : state) {
+        for (size_t i = 0; i + 1 < VALUES; ++i) values[i].swap(values[i + 1]);
+        benchmark::DoNotOptimize(values.data());
+    }
+    state.SetItemsProcessed(state.iterations() * (VALUES - 1));
+}
+BENCHMARK(BM_Swap<AnyType>);
+BENCHMARK(BM_Swap<Variant>);
+BENCHMARK(BM_Swap<std::any>);
+
+// typed get of the type actually stored, the common case of code that knows what it put in
+template <typename Holder>
+static void BM_Get(benchmark::State& state) {
+    std::vector<Holder> values;
+    for (size_t i = 0; i < VALUES; ++i) values.emplace_back(static_cast<double>(i));
+    for (auto _ : state) {
+        double sum = 0;
+        for (auto const& value : values) sum += get<double>(value);
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * VALUES);
+}
+BENCHMARK(BM_Get<AnyType>);
+BENCHMARK(BM_Get<Variant>);
+BENCHMARK(BM_Get<std::any>);
+
+template <typename Holder>
+static void BM_Visit(benchmark::State& state) {
+    auto const values = makeValues<Holder>();
+    for (auto _ : state) {
+        double sum = 0;
+        for (auto const& value : values) sum += toDouble(value);
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * VALUES);
+}
+BENCHMARK(BM_Visit<AnyType>);
+BENCHMARK(BM_Visit<Variant>);
+BENCHMARK(BM_Visit<std::any>);
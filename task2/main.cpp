@@ -1,5 +1,8 @@
 #include <cstdio>
+#include <format>
+#include "AnyColumn.hpp"
 #include "AnyType.hpp"
+#include "AnyTypeFormat.hpp"
 
 int main() {
     AnyType a = 42;
@@ -27,7 +30,22 @@ int main() {
     std::printf("a: %c\n", a.get<char>());
     std::printf("b: %f\n", b.get<float>());
     std::printf("c: %d\n", c.get<int>());
-    std::printf("d: %f\n", d.get<float>());
+    std::printf("d: %f\n\n", d.get<float>());
+
+    // typed dispatch
+    visit([](auto& value) { value += 1; }, d);
+    std::printf("c + d: %f\n", visit([](auto x, auto y) { return static_cast<double>(x + y); }, c, d));
+    std::printf("d: %f\n\n", d.get<float>());
+
+    // std::format, padded like a string
+    std::printf("[%s] [%s]\n\n", std::format("{:>12}", d).c_str(), std::format("{:<6}", c).c_str());
+
+    // column of mixed values
+    AnyColumn column;
+    for (auto const& value : {a, b, c, d}) column.push_back(value);
+    column.push_back(1.5);
+    std::printf("column sum: %f, min: %f, max: %f\n", column.sum(), *column.min(), *column.max());
+    std::printf("column floats: %zu\n", column.filter<float>().size());
 
     return 0;
 }
@@ -0,0 +1,395 @@
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include <gtest/gtest.h>
+#include "AnyBinary.hpp"
+#include "AnyColumn.hpp"
+#include "AnyType.hpp"
+#include "AtomicAnyType.hpp"
+
+// Operators and visit are usable in constant expressions
+static_assert((AnyType(2) + AnyType(3)).get<int>() == 5);
+static_assert((AnyType(7) - AnyType(2.5)).get<double>() == 4.5);
+static_assert((AnyType(6u) * AnyType(7)).type() == AnyType::Type::UInt);
+static_assert((AnyType(short{9}) / AnyType(short{2})).get<int>() == 4);
+static_assert(AnyType(1) == AnyType(1.0));
+static_assert(AnyType(-1) < AnyType(1u));
+static_assert(AnyType(16777217) != AnyType(16777216.0f));
+static_assert((AnyType(1.0) <=> AnyType(std::numeric_limits<double>::quiet_NaN())) == std::partial_ordering::unordered);
+static_assert(visit([](auto x) { return sizeof(x); }, AnyType(1.0)) == sizeof(double));
+static_assert(visit([](auto x, auto y) { return static_cast<long long>(x + y); }, CompactAnyType('a'), CompactAnyType(1)) == 'b');
+static_assert((NanBoxedAnyType(true) + NanBoxedAnyType(2)).get<int>() == 3);
+static_assert(NanBoxedAnyType(-5).get<int>() == -5);
+
+// every type the layout can hold, as AnyType values with a distinctive value each
+template <typename Any>
+std::vector<Any> sampleValues() {
+    std::vector<Any> values;
+    auto const add = [&]<typename T>(T value) {
+        if constexpr (Any::template supports<T>) values.emplace_back(value);
+    };
+    add(true);
+    add('x');
+    add(static_cast<unsigned char>(200));
+    add(static_cast<short>(-1234));
+    add(static_cast<unsigned short>(54321));
+    add(-123456);
+    add(3000000000u);
+    add(-1234567890123L);
+    add(1234567890123UL);
+    add(std::numeric_limits<long long>::min());
+    add(std::numeric_limits<unsigned long long>::max());
+    add(1.25f);
+    add(-2.5e300);
+    add(1.0L / 3);
+    return values;
+}
+
+// Values keep their type and their bits
+template <typename Any>
+void expectSame(std::vector<Any> const& expected, std::vector<Any> const& actual) {
+    ASSERT_EQ(expected.size(), actual.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(expected[i].type(), actual[i].type()) << i;
+        EXPECT_EQ(expected[i], actual[i]) << i;
+    }
+}
+
+template <AnyLayout Layout>
+std::vector<BasicAnyType<Layout>> readAll(BasicAnyReader<Layout> const& reader) {
+    std::vector<BasicAnyType<Layout>> values;
+    for (auto value : reader) values.push_back(value);
+    return values;
+}
+
+// Test writing and reading back every type, one value at a time
+TEST(AnyBinaryTest, RoundTripEveryType) {
+    auto values = sampleValues<AnyType>();
+    ASSERT_EQ(values.size(), detail::ANY_TYPE_COUNT);
+
+    AnyWriter writer;
+    for (auto const& value : values) writer.write(value);
+
+    AnyReader reader(writer.data());
+    EXPECT_TRUE(reader.valid());
+    expectSame(values, readAll(reader));
+}
+
+// Test that long double keeps only the bytes carrying the value
+TEST(AnyBinaryTest, LongDoublePayload) {
+    AnyWriter writer;
+    writer.write(AnyType(1.0L / 3));
+    EXPECT_EQ(writer.data().size(), detail::ANY_HEADER_SIZE + 1 + detail::ANY_LONG_DOUBLE_BYTES);
+    if constexpr (std::numeric_limits<long double>::digits == 64) {
+        EXPECT_EQ(detail::ANY_LONG_DOUBLE_BYTES, 10u);
+    }
+
+    AnyReader reader(writer.data());
+    auto it = reader.begin();
+    ASSERT_NE(it, reader.end());
+    EXPECT_EQ((*it).get<long double>(), 1.0L / 3);
+}
+
+// Test that stretches of one type are stored as runs
+TEST(AnyBinaryTest, Runs) {
+    std::vector<AnyType> values;
+    for (int i = 0; i < 100; ++i) values.emplace_back(i);
+    values.emplace_back(1.5);
+    values.emplace_back(true);
+    for (int i = 0; i < 10; ++i) values.emplace_back(static_cast<double>(i) / 4);
+
+    AnyWriter writer;
+    writer.write(values);
+
+    std::vector<std::pair<AnyType::Type, std::size_t>> records;
+    AnyReader reader(writer.data());
+    EXPECT_TRUE(reader.for_each_record([&](AnyType::Type type, std::size_t count, std::byte const*) {
+        records.emplace_back(type, count);
+    }));
+    std::vector<std::pair<AnyType::Type, std::size_t>> expected = {
+        {AnyType::Type::Int, 100}, {AnyType::Type::Double, 1}, {AnyType::Type::Bool, 1}, {AnyType::Type::Double, 10},
+    };
+    EXPECT_EQ(records, expected);
+    expectSame(values, readAll(reader));
+
+    // short stretches are cheaper as single values
+    writer.clear();
+    writer.write(std::vector<AnyType>{1, 2, 3});
+    EXPECT_EQ(writer.data().size(), detail::ANY_HEADER_SIZE + 3 * (1 + sizeof(int)));
+
+    writer.clear();
+    std::vector<float> floats = {1, 2, 3, 4, 5, 6, 7, 8};
+    writer.write_run(std::span<float const>(floats));
+    EXPECT_EQ(writer.data().size(), detail::ANY_HEADER_SIZE + detail::ANY_RUN_HEADER_SIZE + floats.size() * sizeof(float));
+    AnyReader runReader(writer.data());
+    std::vector<float> read;
+    for (auto value : runReader) read.push_back(value.get<float>());
+    EXPECT_EQ(read, floats);
+}
+
+// Test that truncated and foreign buffers are rejected
+TEST(AnyBinaryTest, MalformedBuffers) {
+    AnyWriter writer;
+    writer.write(AnyType(1));
+    writer.write(std::vector<AnyType>(20, AnyType(2.0)));
+    auto data = writer.data();
+
+    // every prefix cut inside a record is invalid, and iteration stops at the last whole record
+    auto const firstRecordEnd = detail::ANY_HEADER_SIZE + 1 + sizeof(int);
+    for (std::size_t size = detail::ANY_HEADER_SIZE + 1; size < data.size(); ++size) {
+        if (size == firstRecordEnd) continue;
+        AnyReader reader(data.first(size));
+        EXPECT_FALSE(reader.valid()) << size;
+        EXPECT_EQ(readAll(reader).size(), size < firstRecordEnd ? 0u : 1u) << size;
+    }
+
+    // header only: valid and empty
+    AnyReader empty(data.first(detail::ANY_HEADER_SIZE));
+    EXPECT_TRUE(empty.valid());
+    EXPECT_EQ(empty.begin(), empty.end());
+
+    // another format version, or not even a header
+    std::vector<std::byte> foreign(data.begin(), data.end());
+    foreign[3] = std::byte{detail::ANY_FORMAT_VERSION + 1};
+    EXPECT_FALSE(AnyReader(foreign).valid());
+    EXPECT_EQ(AnyReader(foreign).begin(), AnyReader(foreign).end());
+    EXPECT_FALSE(AnyReader(data.first(4)).valid());
+
+    // unknown type tag
+    std::vector<std::byte> badTag(data.begin(), data.end());
+    badTag[detail::ANY_HEADER_SIZE] = std::byte{detail::ANY_TYPE_COUNT};
+    EXPECT_FALSE(AnyReader(badTag).valid());
+
+    // empty run
+    std::vector<std::byte> emptyRun(data.begin(), data.begin() + detail::ANY_HEADER_SIZE);
+    emptyRun.push_back(std::byte{static_cast<std::uint8_t>(AnyType::Type::Int) | detail::ANY_RUN_FLAG});
+    emptyRun.insert(emptyRun.end(), 4, std::byte{0});
+    EXPECT_FALSE(AnyReader(emptyRun).valid());
+}
+
+// Test that a reader stops at types its layout cannot hold
+TEST(AnyBinaryTest, LayoutMismatch) {
+    AnyWriter writer;
+    writer.write(AnyType(1));
+    writer.write(AnyType(2.5));
+    writer.write(AnyType(1.5f));
+    writer.write(AnyType(3));
+
+    BasicAnyReader<AnyLayout::NanBoxed> reader(writer.data());
+    EXPECT_TRUE(reader.valid());
+    auto read = readAll(reader);
+    ASSERT_EQ(read.size(), 2u);
+    EXPECT_EQ(read[0].get<int>(), 1);
+    EXPECT_EQ(read[1].get<double>(), 2.5);
+
+    BasicAnyReader<AnyLayout::Compact> compact(writer.data());
+    EXPECT_EQ(readAll(compact).size(), 4u);
+}
+
+// Test which types each layout holds
+TEST(AnyTypeTest, LayoutSupport) {
+    EXPECT_EQ(sampleValues<AnyType>().size(), detail::ANY_TYPE_COUNT);
+    EXPECT_EQ(sampleValues<CompactAnyType>().size(), detail::ANY_TYPE_COUNT - 1);
+    EXPECT_EQ(sampleValues<NanBoxedAnyType>().size(), 3u);
+
+    EXPECT_TRUE(AnyType::supports<long double>);
+    EXPECT_FALSE(CompactAnyType::supports<long double>);
+    EXPECT_TRUE(NanBoxedAnyType::supports<bool>);
+    EXPECT_TRUE(NanBoxedAnyType::supports<int>);
+    EXPECT_TRUE(NanBoxedAnyType::supports<double>);
+    EXPECT_FALSE(NanBoxedAnyType::supports<float>);
+    EXPECT_FALSE(NanBoxedAnyType::supports<long long>);
+
+    EXPECT_FALSE(NanBoxedAnyType(1).is<float>());
+    EXPECT_TRUE(NanBoxedAnyType(1).is<int>());
+}
+
+// Test doubles at the edges of the NaN-boxing space
+TEST(AnyTypeTest, NanBoxedEdgeCases) {
+    constexpr double inf = std::numeric_limits<double>::infinity();
+    for (double value : {0.0, -0.0, inf, -inf, std::numeric_limits<double>::denorm_min(),
+                         std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest()}) {
+        NanBoxedAnyType boxed(value);
+        ASSERT_EQ(boxed.type(), AnyType::Type::Double) << value;
+        EXPECT_EQ(std::bit_cast<std::uint64_t>(boxed.get<double>()), std::bit_cast<std::uint64_t>(value)) << value;
+    }
+    EXPECT_TRUE(std::signbit(NanBoxedAnyType(-0.0).get<double>()));
+
+    // NaNs of any sign and payload stay NaN doubles, none of them is taken for a boxed value
+    for (std::uint64_t bits : {0x7FF8'0000'0000'0000ull, 0xFFF8'0000'0000'0000ull, 0xFFF9'0000'0000'0001ull,
+                               0xFFFA'0000'0000'002Aull, 0xFFFF'FFFF'FFFF'FFFFull, 0x7FF0'0000'0000'0001ull}) {
+        NanBoxedAnyType boxed(std::bit_cast<double>(bits));
+        EXPECT_EQ(boxed.type(), AnyType::Type::Double) << std::hex << bits;
+        EXPECT_TRUE(std::isnan(boxed.get<double>())) << std::hex << bits;
+        EXPECT_FALSE(boxed == boxed);
+    }
+
+    // boxed values use the whole 32-bit payload
+    for (int value : {0, -1, 1, std::numeric_limits<int>::min(), std::numeric_limits<int>::max()}) {
+        NanBoxedAnyType boxed(value);
+        EXPECT_EQ(boxed.type(), AnyType::Type::Int);
+        EXPECT_EQ(boxed.get<int>(), value);
+    }
+    EXPECT_EQ(NanBoxedAnyType(false).get<bool>(), false);
+    EXPECT_EQ(NanBoxedAnyType(true).get<bool>(), true);
+    EXPECT_THROW((void)NanBoxedAnyType(1).get<double>(), std::bad_variant_access);
+}
+
+// Test that comparisons are exact across types
+TEST(AnyTypeTest, CrossTypeComparison) {
+    EXPECT_EQ(AnyType(1), AnyType(1u));
+    EXPECT_EQ(AnyType(1), AnyType(1.0));
+    EXPECT_EQ(AnyType(1), AnyType(true));
+    EXPECT_EQ(AnyType(1.0f), AnyType(1.0L));
+    EXPECT_LT(AnyType(-1), AnyType(0u));
+    EXPECT_LT(AnyType(std::numeric_limits<long long>::max()), AnyType(std::numeric_limits<unsigned long long>::max()));
+
+    // the built-in conversions round these, the comparison does not
+    EXPECT_NE(AnyType(16777217), AnyType(16777216.0f));
+    EXPECT_GT(AnyType(16777217), AnyType(16777216.0f));
+    EXPECT_NE(AnyType(9007199254740993LL), AnyType(9007199254740992.0));
+    EXPECT_LT(AnyType(std::numeric_limits<long long>::max()), AnyType(9223372036854775808.0));
+    EXPECT_GT(AnyType(std::numeric_limits<unsigned long long>::max()), AnyType(1.8e19));
+    EXPECT_LT(AnyType(2), AnyType(2.5));
+    EXPECT_GT(AnyType(-2), AnyType(-2.5));
+
+    auto nan = AnyType(std::numeric_limits<double>::quiet_NaN());
+    EXPECT_EQ(nan <=> AnyType(0), std::partial_ordering::unordered);
+    EXPECT_NE(nan, nan);
+}
+
+// Test that values which compare equal hash equally
+TEST(AnyTypeTest, HashConsistentWithEquality) {
+    std::hash<AnyType> hash;
+    std::vector<AnyType> ones = {AnyType(1), AnyType(1u), AnyType(1.0), AnyType(1.0f), AnyType(true),
+                                 AnyType(1L), AnyType(1ULL), AnyType(1.0L), AnyType(static_cast<char>(1))};
+    for (auto const& one : ones) {
+        EXPECT_EQ(one, ones.front());
+        EXPECT_EQ(hash(one), hash(ones.front()));
+    }
+    EXPECT_EQ(hash(AnyType(0.0)), hash(AnyType(-0.0)));
+    EXPECT_EQ(hash(AnyType(std::numeric_limits<unsigned long long>::max())),
+              hash(AnyType(static_cast<long double>(std::numeric_limits<unsigned long long>::max()))));
+    EXPECT_EQ(hash(AnyType(0.5f)), hash(AnyType(0.5)));
+    EXPECT_EQ(hash(AnyType(0.1L)), std::hash<long double>{}(0.1L));
+
+    std::unordered_set<AnyType> keys(ones.begin(), ones.end());
+    EXPECT_EQ(keys.size(), 1u);
+    keys.insert(AnyType(2.0));
+    keys.insert(AnyType(2));
+    keys.insert(AnyType(2.5));
+    EXPECT_EQ(keys.size(), 3u);
+}
+
+// Test parsing into the narrowest type
+TEST(AnyTypeTest, Parse) {
+    EXPECT_EQ(AnyType::parse("12")->type(), AnyType::Type::Short);
+    EXPECT_EQ(AnyType::parse("-70000")->type(), AnyType::Type::Int);
+    EXPECT_EQ(AnyType::parse("18446744073709551615")->type(), AnyType::Type::ULongLong);
+    EXPECT_EQ(AnyType::parse("1.5")->type(), AnyType::Type::Float);
+    EXPECT_EQ(AnyType::parse("1.23456789")->type(), AnyType::Type::Double);
+    EXPECT_EQ(AnyType::parse("true")->type(), AnyType::Type::Bool);
+    EXPECT_FALSE(AnyType::parse(""));
+    EXPECT_FALSE(AnyType::parse("1x"));
+    EXPECT_FALSE(AnyType::parse("18446744073709551616"));
+
+    EXPECT_EQ(NanBoxedAnyType::parse("12")->type(), AnyType::Type::Int);
+    EXPECT_EQ(NanBoxedAnyType::parse("1.5")->type(), AnyType::Type::Double);
+    // integers no type holds are not rounded
+    EXPECT_FALSE(NanBoxedAnyType::parse("9007199254740993"));
+    EXPECT_FALSE(NanBoxedAnyType::parse("-3000000000"));
+
+    std::array<AnyType, 4> out{AnyType(0), AnyType(0), AnyType(0), AnyType(0)};
+    EXPECT_EQ(AnyType::parse_line("1,2.5,x,4", ',', out), 2u);
+    EXPECT_EQ(out[1], AnyType(2.5));
+}
+
+// Test compare_exchange, which matches the exact type and bits
+TEST(AtomicAnyTypeTest, CompareExchange) {
+    AtomicAnyType atomic(AnyType(1));
+
+    AnyType expected = 1.0;
+    EXPECT_FALSE(atomic.compare_exchange(expected, AnyType(2)));
+    EXPECT_EQ(expected.type(), AnyType::Type::Int);
+    EXPECT_EQ(atomic.load().get<int>(), 1);
+
+    EXPECT_TRUE(atomic.compare_exchange(expected, AnyType(2.5f)));
+    EXPECT_EQ(atomic.load().get<float>(), 2.5f);
+
+    // a NaN matches itself, unlike with ==
+    auto nan = AnyType(std::numeric_limits<double>::quiet_NaN());
+    atomic.store(nan);
+    EXPECT_TRUE(atomic.compare_exchange(nan, AnyType(1.0L)));
+    EXPECT_EQ(atomic.load().get<long double>(), 1.0L);
+
+    EXPECT_EQ(atomic.exchange(AnyType('z')).get<long double>(), 1.0L);
+    EXPECT_EQ(atomic.load().get<char>(), 'z');
+}
+
+// Test fetch_add, which keeps the stored type, from several threads
+TEST(AtomicAnyTypeTest, FetchAdd) {
+    AtomicAnyType counter(AnyType(0LL));
+    EXPECT_EQ(counter.fetch_add(AnyType(2.9)).get<long long>(), 0);
+    EXPECT_EQ(counter.load().get<long long>(), 2);
+
+    constexpr int THREADS = 4;
+    constexpr int ADDS = 10000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < ADDS; ++i) counter.fetch_add(AnyType(1));
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    EXPECT_EQ(counter.load().get<long long>(), 2 + THREADS * ADDS);
+
+    BasicAtomicAnyType<AnyLayout::NanBoxed> boxed(NanBoxedAnyType(1.5));
+    boxed.fetch_add(NanBoxedAnyType(1));
+    EXPECT_EQ(boxed.load().get<double>(), 2.5);
+}
+
+// Test the batch operations over runs of mixed types
+TEST(AnyColumnTest, SumMinMax) {
+    AnyColumn column;
+    EXPECT_FALSE(column.min());
+    EXPECT_FALSE(column.max());
+    EXPECT_EQ(column.sum(), 0.0);
+
+    for (int i = 1; i <= 10; ++i) column.push_back(i);
+    column.push_back(-2.5);
+    column.push_back(std::numeric_limits<unsigned long long>::max());
+    column.push_back(std::numeric_limits<long long>::min());
+    std::vector<float> floats = {0.5f, 0.25f, 100.0f};
+    column.append(std::span<float const>(floats));
+    column.push_back(1.0L / 4);
+    column.push_back(true);
+    column.push_back('A');
+
+    ASSERT_EQ(column.size(), 19u);
+    EXPECT_EQ(column.type(10), AnyType::Type::Double);
+    EXPECT_EQ(column[11], AnyType(std::numeric_limits<unsigned long long>::max()));
+    EXPECT_EQ(column[12], AnyType(std::numeric_limits<long long>::min()));
+    EXPECT_EQ(column[16].get<long double>(), 0.25L);
+
+    double expected = 0;
+    for (std::size_t i = 0; i < column.size(); ++i) expected += visit([](auto x) { return static_cast<double>(x); }, column[i]);
+    EXPECT_DOUBLE_EQ(column.sum(), expected);
+    EXPECT_EQ(*column.max(), static_cast<double>(std::numeric_limits<unsigned long long>::max()));
+    EXPECT_EQ(*column.min(), static_cast<double>(std::numeric_limits<long long>::min()));
+
+    EXPECT_EQ(column.count(AnyType::Type::Int), 10u);
+    EXPECT_EQ(column.filter<float>(), floats);
+    EXPECT_EQ(column.to_double()[10], -2.5);
+
+    AnyColumn small;
+    small.append(std::span<float const>(floats));
+    small.push_back(-1);
+    small.push_back(0.125L);
+    EXPECT_EQ(*small.min(), -1.0);
+    EXPECT_EQ(*small.max(), 100.0);
+    EXPECT_DOUBLE_EQ(small.sum(), 99.875);
+}
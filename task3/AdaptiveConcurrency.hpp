@@ -0,0 +1,51 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+#include "ThreadPool.hpp"
+
+// Adjusts how many reads a pool runs at once by how long they take. Reads served from the page
+// cache finish in microseconds, more concurrent ones only contend for the same cores. Reads that
+// wait on the device take milliseconds, and more of them in flight keep its queue full.
+// The concurrency doubles or halves after every window of reads whose mean latency leaves the band.
+class AdaptiveConcurrency {
+public:
+    static constexpr size_t WINDOW = 32;
+    static constexpr std::chrono::microseconds FAST_READ{50};
+    static constexpr std::chrono::microseconds SLOW_READ{500};
+
+    AdaptiveConcurrency(ThreadPool& pool, size_t minimum, size_t maximum, size_t initial)
+        : m_pool(pool), m_minimum(minimum), m_maximum(maximum), m_concurrency(std::clamp(initial, minimum, maximum)) {
+        m_pool.setConcurrency(m_concurrency);
+    }
+
+    void record(std::chrono::nanoseconds latency) {
+        std::lock_guard lock(m_mutex);
+        m_total += latency;
+        if (++m_samples < WINDOW) return;
+
+        auto mean = m_total / m_samples;
+        m_total = {};
+        m_samples = 0;
+        if (mean > SLOW_READ && m_concurrency < m_maximum) {
+            m_concurrency = std::min(m_maximum, m_concurrency * 2);
+        } else if (mean < FAST_READ && m_concurrency > m_minimum) {
+            m_concurrency = std::max(m_minimum, m_concurrency / 2);
+        } else {
+            return;
+        }
+        m_pool.setConcurrency(m_concurrency);
+    }
+
+private:
+    ThreadPool& m_pool;
+    size_t m_minimum;
+    size_t m_maximum;
+    size_t m_concurrency;
+    std::chrono::nanoseconds m_total{};
+    size_t m_samples = 0;
+    std::mutex m_mutex;
+};
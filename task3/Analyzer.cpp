@@ -1,195 +1,229 @@
 #include "Analyzer.hpp"
 
+#include <array>
 #include <fstream>
 #include <iostream>
 #include <print>
 #include <span>
 
-std::optional<FileInfo> analyze(std::filesystem::path const& path) {
-    std::ifstream file;
-    file.rdbuf()->pubsetbuf(nullptr, 0);
-    file.open(path, std::ios::binary);
-    if (!file) {
-        std::println(std::cerr, "Failed to open file: {}", path.string());
-        return std::nullopt;
-    }
-
-    constexpr size_t BUFFER_SIZE = 64 * 1024; // 64 KiB
-    std::array<char, BUFFER_SIZE> buffer;
+namespace {
+    using State = IncrementalAnalyzer::State;
 
-    auto ptr = buffer.data();
-    auto end = buffer.data() + buffer.size();
-
-    auto const readNextChunk = [&]() -> bool {
-        if (!file || file.eof()) return false;
-        file.read(buffer.data(), buffer.size());
-        ptr = buffer.data(); // reset pointer
-        end = buffer.data() + file.gcount();
-        return file.gcount() > 0;
-    };
-
-    auto const peek = [&]() -> char {
-        if (ptr >= end && !readNextChunk()) return '\0';
-        return *ptr;
-    };
-
-    auto const advance = [&]() -> char {
-        if (ptr >= end && !readNextChunk()) return '\0';
-        return *ptr++;
-    };
-
-    FileInfo fi;
-    bool inBlockComment = false; // /* ... */
-    bool inLineComment = false;  // // ...
-    bool inString = false;       // " ... "
-    bool inChar = false;         // ' ... '
-    bool lineNotBlank = false;   // line has non-whitespace characters
-    bool hasCode = false;        // line has code (not comment or whitespace)
-
-    auto const finishLine = [&] {
-        if (!lineNotBlank) {
-            ++fi.blankLines;
-        } else if (hasCode) {
-            ++fi.codeLines;
+    void finishLine(State& state) {
+        if (!state.lineNotBlank) {
+            ++state.info.blankLines;
+        } else if (state.hasCode) {
+            ++state.info.codeLines;
         } else {
-            ++fi.commentLines;
+            ++state.info.commentLines;
         }
-        lineNotBlank = false;
-        hasCode = false;
-    };
-
-    readNextChunk(); // initial read
+        state.lineNotBlank = false;
+        state.hasCode = false;
+    }
 
-    do {
-        char ch = advance();
-        if (ch == '\0') break;
+    // characters whose meaning depends on the one after them
+    bool needsNext(char ch) {
+        return ch == '/' || ch == '*' || ch == '\\';
+    }
 
+    // Classifies ch, next is the character after it or '\0' at the end of the text.
+    // Returns whether next was consumed along with ch.
+    bool classify(State& state, char ch, char next) {
         switch (ch) {
             case '\n': {
-                finishLine();
-                inLineComment = false;
-                break;
+                finishLine(state);
+                state.inLineComment = false;
+                return false;
             }
 
             case '/': {
-                if (inString || inChar) {
-                    lineNotBlank = true;
-                    hasCode = true;
-                    break;
+                if (state.inString || state.inChar) {
+                    state.lineNotBlank = true;
+                    state.hasCode = true;
+                    return false;
                 }
 
                 // check for /*
-                if (!inBlockComment && peek() == '*') {
-                    inBlockComment = true;
-                    lineNotBlank = true;
-                    advance();
-                    break;
+                if (!state.inBlockComment && next == '*') {
+                    state.inBlockComment = true;
+                    state.lineNotBlank = true;
+                    return true;
                 }
 
                 // check for //
-                if (!inBlockComment && peek() == '/') {
-                    inLineComment = true;
-                    lineNotBlank = true;
-                    advance();
-                    break;
+                if (!state.inBlockComment && next == '/') {
+                    state.inLineComment = true;
+                    state.lineNotBlank = true;
+                    return true;
                 }
 
-                if (!inBlockComment && !inLineComment) {
-                    lineNotBlank = true;
-                    hasCode = true;
+                if (!state.inBlockComment && !state.inLineComment) {
+                    state.lineNotBlank = true;
+                    state.hasCode = true;
                 }
 
-                break;
+                return false;
             }
 
             case '*': {
                 // check for */
-                if (inBlockComment && peek() == '/') {
-                    inBlockComment = false;
-                    lineNotBlank = true;
-                    advance();
-                    break;
+                if (state.inBlockComment && next == '/') {
+                    state.inBlockComment = false;
+                    state.lineNotBlank = true;
+                    return true;
                 }
 
-                if (!inBlockComment && !inLineComment) {
-                    lineNotBlank = true;
-                    hasCode = true;
+                if (!state.inBlockComment && !state.inLineComment) {
+                    state.lineNotBlank = true;
+                    state.hasCode = true;
                 } else {
-                    lineNotBlank = true;
+                    state.lineNotBlank = true;
                 }
 
-                break;
+                return false;
             }
 
             case '"': {
-                if (inLineComment || inBlockComment || inChar) {
-                    lineNotBlank = true;
-                    if (!inLineComment && !inBlockComment) hasCode = true;
-                    break;
+                if (state.inLineComment || state.inBlockComment || state.inChar) {
+                    state.lineNotBlank = true;
+                    if (!state.inLineComment && !state.inBlockComment) state.hasCode = true;
+                    return false;
                 }
 
-                inString = !inString;
-                lineNotBlank = true;
-                hasCode = true;
-                break;
+                state.inString = !state.inString;
+                state.lineNotBlank = true;
+                state.hasCode = true;
+                return false;
             }
 
             case '\'': {
-                if (inLineComment || inBlockComment || inString) {
-                    lineNotBlank = true;
-                    if (!inLineComment && !inBlockComment) hasCode = true;
-                    break;
+                if (state.inLineComment || state.inBlockComment || state.inString) {
+                    state.lineNotBlank = true;
+                    if (!state.inLineComment && !state.inBlockComment) state.hasCode = true;
+                    return false;
                 }
 
-                inChar = !inChar;
-                lineNotBlank = true;
-                hasCode = true;
-                break;
+                state.inChar = !state.inChar;
+                state.lineNotBlank = true;
+                state.hasCode = true;
+                return false;
             }
 
             case '\\': {
-                if (inLineComment || inBlockComment) {
-                    lineNotBlank = true;
-                    break;
+                if (state.inLineComment || state.inBlockComment) {
+                    state.lineNotBlank = true;
+                    return false;
                 }
 
-                if (inString || inChar) {
-                    lineNotBlank = true;
-                    hasCode = true;
-                    if (peek()) advance(); // skip escaped char
-                } else if (peek() == '\n') { // line breaks in macros
-                    finishLine();
-                    advance();
-                } else {
-                    lineNotBlank = true;
-                    hasCode = true;
+                if (state.inString || state.inChar) {
+                    state.lineNotBlank = true;
+                    state.hasCode = true;
+                    return next != '\0'; // skip escaped char
+                }
+
+                if (next == '\n') { // line breaks in macros
+                    finishLine(state);
+                    return true;
                 }
 
-                break;
+                state.lineNotBlank = true;
+                state.hasCode = true;
+                return false;
             }
 
             case ' ':
             case '\t':
             case '\r': {
                 // whitespace
-                break;
+                return false;
             }
 
             default: {
-                if (!inBlockComment && !inLineComment) {
-                    lineNotBlank = true;
-                    hasCode = true;
+                if (!state.inBlockComment && !state.inLineComment) {
+                    state.lineNotBlank = true;
+                    state.hasCode = true;
                 } else {
-                    lineNotBlank = true;
+                    state.lineNotBlank = true;
                 }
-                break;
+                return false;
             }
         }
-    } while (true);
+    }
 
-    if (lineNotBlank) {
-        finishLine();
+    // Classifies the characters before last, each with the one after it, up to a NUL character.
+    // Returns last, last + 1 if the character before last took it along, or the NUL.
+    // This is the only caller of classify, which keeps it inlined into the loop, and the state is
+    // a local meanwhile: stores through a reference could alias the text.
+    char const* classifyRun(State& state, char const* ptr, char const* last) {
+        State local = state;
+        while (ptr < last && *ptr != '\0') {
+            char ch = *ptr++;
+            ptr += classify(local, ch, *ptr);
+        }
+        state = local;
+        return ptr;
+    }
+}
+
+void IncrementalAnalyzer::feed(std::span<char const> chunk) {
+    char const* ptr = chunk.data();
+    char const* end = chunk.data() + chunk.size();
+    if (m_ended || ptr == end) return;
+
+    if (m_pending != '\0') {
+        char const joined[] = {m_pending, *ptr};
+        m_pending = '\0';
+        if (classifyRun(m_state, joined, joined + 1) == joined + 2) ++ptr;
+        if (ptr == end) return;
+    }
+
+    char const* last = end - 1;
+    ptr = classifyRun(m_state, ptr, last);
+    if (ptr == end) return;
+    if (*ptr == '\0') {
+        m_ended = true;
+    } else if (needsNext(*ptr)) {
+        m_pending = *ptr;
+    } else {
+        char const single[] = {*ptr, '\0'};
+        classifyRun(m_state, single, single + 1);
+    }
+}
+
+FileInfo IncrementalAnalyzer::finish() {
+    // the end of the text classifies a pending character like a NUL does
+    constexpr char END = '\0';
+    feed({&END, 1});
+    m_ended = true;
+
+    if (m_state.lineNotBlank) {
+        finishLine(m_state);
+    }
+    return m_state.info;
+}
+
+std::optional<FileInfo> analyze(std::filesystem::path const& path) {
+    std::ifstream file;
+    file.rdbuf()->pubsetbuf(nullptr, 0);
+    file.open(path, std::ios::binary);
+    if (!file) {
+        std::println(std::cerr, "Failed to open file: {}", path.string());
+        return std::nullopt;
     }
 
-    return fi;
-}
\ No newline at end of file
+    constexpr size_t BUFFER_SIZE = 64 * 1024; // 64 KiB
+    std::array<char, BUFFER_SIZE> buffer;
+
+    IncrementalAnalyzer analyzer;
+    while (file) {
+        file.read(buffer.data(), buffer.size());
+        analyzer.feed({buffer.data(), static_cast<size_t>(file.gcount())});
+    }
+    return analyzer.finish();
+}
+
+FileInfo analyze(std::span<char const> contents) {
+    IncrementalAnalyzer analyzer;
+    analyzer.feed(contents);
+    return analyzer.finish();
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include <cstddef>
 #include <filesystem>
+#include <optional>
 #include <span>
 
 struct FileInfo {
@@ -25,4 +26,35 @@ struct TypeStats {
     size_t fileCount = 0;
 };
 
-std::optional<FileInfo> analyze(std::filesystem::path const& path);
\ No newline at end of file
+// Classifies the lines of a text fed in chunks of any size, a chunk may end anywhere, even inside
+// a comment delimiter or an escape sequence. The lexer state is carried from one chunk to the
+// next, and copying an analyzer saves its state at that point.
+// Like a whole file, the text ends at its first NUL character.
+class IncrementalAnalyzer {
+public:
+    // the counts of the lines finished so far and the lexer state at the end of the last chunk
+    struct State {
+        FileInfo info;
+        bool inBlockComment = false; // /* ... */
+        bool inLineComment = false;  // // ...
+        bool inString = false;       // " ... "
+        bool inChar = false;         // ' ... '
+        bool lineNotBlank = false;   // line has non-whitespace characters
+        bool hasCode = false;        // line has code (not comment or whitespace)
+    };
+
+    void feed(std::span<char const> chunk);
+
+    // classifies the last line if it has no line break and returns the counts of the whole text
+    FileInfo finish();
+
+private:
+    State m_state;
+    char m_pending = '\0'; // last character of a chunk that needs the next one to be classified
+    bool m_ended = false;  // a NUL character was fed
+};
+
+std::optional<FileInfo> analyze(std::filesystem::path const& path);
+
+// classifies the lines of a file already in memory
+FileInfo analyze(std::span<char const> contents);
\ No newline at end of file
@@ -0,0 +1,438 @@
+#include "Archive.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <print>
+
+#ifdef TASK3_HAVE_ZLIB
+#include <climits>
+#include <zlib.h>
+#endif
+
+#ifdef TASK3_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+    constexpr size_t BLOCK_SIZE = 512;
+    constexpr size_t BUFFER_SIZE = 64 * 1024; // 64 KiB
+
+    // long names and pax headers are metadata, anything larger is a corrupted archive
+    constexpr uint64_t MAX_METADATA_SIZE = 1024 * 1024;
+
+    enum class Compression {
+        NotArchive,
+        None, // .tar
+        Gzip, // .tar.gz, .tgz
+        Zstd, // .tar.zst
+    };
+
+    Compression compressionOf(std::filesystem::path const& path) {
+        auto name = path.filename().string();
+        if (name.ends_with(".tar")) return Compression::None;
+        if (name.ends_with(".tar.gz") || name.ends_with(".tgz")) return Compression::Gzip;
+        if (name.ends_with(".tar.zst")) return Compression::Zstd;
+        return Compression::NotArchive;
+    }
+
+    // sequential stream of the decompressed archive
+    class Source {
+    public:
+        virtual ~Source() = default;
+
+        [[nodiscard]] virtual bool isOpen() const = 0;
+        [[nodiscard]] virtual bool failed() const = 0;
+
+        // reads up to size bytes, returns 0 at the end of the stream or on error
+        virtual size_t read(char* data, size_t size) = 0;
+
+        // bytes left in the stream, if known without reading them
+        virtual std::optional<uint64_t> remaining() { return std::nullopt; }
+
+        virtual bool skip(uint64_t size) {
+            std::array<char, BUFFER_SIZE> scratch;
+            while (size > 0) {
+                auto n = read(scratch.data(), static_cast<size_t>(std::min<uint64_t>(size, scratch.size())));
+                if (n == 0) return false;
+                size -= n;
+            }
+            return true;
+        }
+
+        // reads until size bytes are read or the stream ends, returns the number of bytes read
+        size_t readFully(char* data, size_t size) {
+            size_t done = 0;
+            while (done < size) {
+                auto n = read(data + done, size - done);
+                if (n == 0) break;
+                done += n;
+            }
+            return done;
+        }
+
+        // Reads size bytes into a buffer that grows as they arrive, so that a corrupted size in a
+        // header ends in a short read instead of allocating that much up front.
+        bool readGrowing(std::vector<char>& out, uint64_t size) {
+            out.clear();
+            while (out.size() < size) {
+                auto chunk = static_cast<size_t>(std::min<uint64_t>(size - out.size(), std::max(out.size(), BUFFER_SIZE)));
+                auto done = out.size();
+                out.resize(done + chunk);
+                if (readFully(out.data() + done, chunk) != chunk) return false;
+            }
+            return true;
+        }
+    };
+
+    class FileSource final : public Source {
+    public:
+        explicit FileSource(std::filesystem::path const& path) {
+            m_file.rdbuf()->pubsetbuf(nullptr, 0);
+            m_file.open(path, std::ios::binary);
+            std::error_code ec;
+            m_size = std::filesystem::file_size(path, ec);
+            if (ec) m_size = 0;
+        }
+
+        [[nodiscard]] bool isOpen() const override { return m_file.is_open(); }
+        [[nodiscard]] bool failed() const override { return m_file.bad(); }
+
+        size_t read(char* data, size_t size) override {
+            m_file.read(data, static_cast<std::streamsize>(size));
+            return static_cast<size_t>(m_file.gcount());
+        }
+
+        std::optional<uint64_t> remaining() override {
+            auto position = m_file.tellg();
+            if (position < 0) return std::nullopt;
+            return m_size - std::min<uint64_t>(m_size, static_cast<uint64_t>(position));
+        }
+
+        // plain archives skip members without reading them
+        bool skip(uint64_t size) override {
+            if (auto left = remaining(); left && size > *left) return false;
+            m_file.seekg(static_cast<std::streamoff>(size), std::ios::cur);
+            return static_cast<bool>(m_file);
+        }
+
+    private:
+        std::ifstream m_file;
+        uint64_t m_size = 0;
+    };
+
+#ifdef TASK3_HAVE_ZLIB
+    class GzipSource final : public Source {
+    public:
+        explicit GzipSource(std::filesystem::path const& path) : m_file(gzopen(path.string().c_str(), "rb")) {
+            if (m_file) gzbuffer(m_file, BUFFER_SIZE);
+        }
+
+        GzipSource(GzipSource const&) = delete;
+        GzipSource& operator=(GzipSource const&) = delete;
+
+        ~GzipSource() override {
+            if (m_file) gzclose(m_file);
+        }
+
+        [[nodiscard]] bool isOpen() const override { return m_file != nullptr; }
+        [[nodiscard]] bool failed() const override { return m_failed; }
+
+        size_t read(char* data, size_t size) override {
+            if (m_failed) return 0;
+            auto n = gzread(m_file, data, static_cast<unsigned>(std::min<size_t>(size, INT_MAX)));
+            if (n < 0) {
+                m_failed = true;
+                return 0;
+            }
+            return static_cast<size_t>(n);
+        }
+
+    private:
+        gzFile m_file;
+        bool m_failed = false;
+    };
+#endif
+
+#ifdef TASK3_HAVE_ZSTD
+    class ZstdSource final : public Source {
+    public:
+        explicit ZstdSource(std::filesystem::path const& path)
+            : m_stream(ZSTD_createDStream()), m_buffer(ZSTD_DStreamInSize()) {
+            m_file.rdbuf()->pubsetbuf(nullptr, 0);
+            m_file.open(path, std::ios::binary);
+            if (m_stream) ZSTD_initDStream(m_stream);
+        }
+
+        ZstdSource(ZstdSource const&) = delete;
+        ZstdSource& operator=(ZstdSource const&) = delete;
+
+        ~ZstdSource() override { ZSTD_freeDStream(m_stream); }
+
+        [[nodiscard]] bool isOpen() const override { return m_file.is_open() && m_stream; }
+        [[nodiscard]] bool failed() const override { return m_failed; }
+
+        size_t read(char* data, size_t size) override {
+            ZSTD_outBuffer output{data, size, 0};
+            while (output.pos == 0 && !m_failed) {
+                if (m_input.pos == m_input.size) {
+                    m_file.read(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+                    auto n = static_cast<size_t>(m_file.gcount());
+                    if (n == 0) {
+                        m_failed = m_file.bad() || m_frameRemaining != 0; // truncated frame
+                        break;
+                    }
+                    m_input = {m_buffer.data(), n, 0};
+                }
+                auto result = ZSTD_decompressStream(m_stream, &output, &m_input);
+                if (ZSTD_isError(result)) {
+                    m_failed = true;
+                    break;
+                }
+                m_frameRemaining = result;
+            }
+            return output.pos;
+        }
+
+    private:
+        std::ifstream m_file;
+        ZSTD_DStream* m_stream;
+        std::vector<char> m_buffer;
+        ZSTD_inBuffer m_input{nullptr, 0, 0};
+        size_t m_frameRemaining = 0;
+        bool m_failed = false;
+    };
+#endif
+
+    std::unique_ptr<Source> openSource(std::filesystem::path const& path) {
+        switch (compressionOf(path)) {
+            case Compression::None:
+                return std::make_unique<FileSource>(path);
+            case Compression::Gzip:
+#ifdef TASK3_HAVE_ZLIB
+                return std::make_unique<GzipSource>(path);
+#else
+                std::println(std::cerr, "Cannot read {}: built without gzip support", path.string());
+                return nullptr;
+#endif
+            case Compression::Zstd:
+#ifdef TASK3_HAVE_ZSTD
+                return std::make_unique<ZstdSource>(path);
+#else
+                std::println(std::cerr, "Cannot read {}: built without zstd support", path.string());
+                return nullptr;
+#endif
+            default:
+                std::println(std::cerr, "Not an archive: {}", path.string());
+                return nullptr;
+        }
+    }
+
+    // POSIX ustar header, every field is text
+    struct TarHeader {
+        char name[100];
+        char mode[8];
+        char uid[8];
+        char gid[8];
+        char size[12];
+        char mtime[12];
+        char checksum[8];
+        char typeflag;
+        char linkname[100];
+        char magic[6];
+        char version[2];
+        char uname[32];
+        char gname[32];
+        char devmajor[8];
+        char devminor[8];
+        char prefix[155];
+        char padding[12];
+    };
+    static_assert(sizeof(TarHeader) == BLOCK_SIZE);
+
+    // the field up to its first NUL, fields that fill their whole size have none
+    template <size_t N>
+    std::string_view fieldString(char const (&field)[N]) {
+        return {field, std::find(field, field + N, '\0')};
+    }
+
+    // octal padded with spaces or NULs, or GNU base-256 if the high bit of the first byte is set
+    template <size_t N>
+    std::optional<uint64_t> fieldNumber(char const (&field)[N]) {
+        auto const first = static_cast<unsigned char>(field[0]);
+        if (first & 0x80) {
+            if (first & 0x40) return std::nullopt; // negative
+            uint64_t value = first & 0x3f;
+            for (size_t i = 1; i < N; ++i) {
+                if (value >> 56) return std::nullopt;
+                value = value << 8 | static_cast<unsigned char>(field[i]);
+            }
+            return value;
+        }
+
+        size_t i = 0;
+        while (i < N && field[i] == ' ') ++i;
+        uint64_t value = 0;
+        for (; i < N && field[i] >= '0' && field[i] <= '7'; ++i) {
+            value = value * 8 + (field[i] - '0');
+        }
+        for (; i < N; ++i) {
+            if (field[i] != ' ' && field[i] != '\0') return std::nullopt;
+        }
+        return value;
+    }
+
+    bool isZeroBlock(TarHeader const& header) {
+        auto bytes = reinterpret_cast<char const*>(&header);
+        return std::all_of(bytes, bytes + BLOCK_SIZE, [](char ch) { return ch == '\0'; });
+    }
+
+    // the checksum is the sum of the header bytes with the checksum field taken as spaces,
+    // some old writers summed signed chars
+    bool checksumValid(TarHeader const& header) {
+        auto expected = fieldNumber(header.checksum);
+        if (!expected) return false;
+
+        auto bytes = reinterpret_cast<char const*>(&header);
+        auto const checksumBegin = offsetof(TarHeader, checksum);
+        auto const checksumEnd = checksumBegin + sizeof(header.checksum);
+        uint64_t unsignedSum = 0;
+        int64_t signedSum = 0;
+        for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+            char ch = i >= checksumBegin && i < checksumEnd ? ' ' : bytes[i];
+            unsignedSum += static_cast<unsigned char>(ch);
+            signedSum += static_cast<signed char>(ch);
+        }
+        return *expected == unsignedSum || static_cast<int64_t>(*expected) == signedSum;
+    }
+
+    std::string memberName(TarHeader const& header) {
+        auto name = fieldString(header.name);
+        // GNU tar keeps other fields where POSIX has the prefix, and writes "ustar  " as magic
+        bool posix = std::string_view(header.magic, sizeof(header.magic)) == std::string_view("ustar\0", 6);
+        auto prefix = posix ? fieldString(header.prefix) : std::string_view{};
+        if (prefix.empty()) return std::string(name);
+        return std::string(prefix) + '/' + std::string(name);
+    }
+
+    // pax extended header records are "<length> <key>=<value>\n", only the path is of interest
+    std::string paxPath(std::string_view records) {
+        std::string path;
+        while (!records.empty()) {
+            auto space = records.find(' ');
+            if (space == std::string_view::npos) break;
+            size_t length = 0;
+            auto [_, ec] = std::from_chars(records.data(), records.data() + space, length);
+            if (ec != std::errc{} || length < space + 2 || length > records.size()) break;
+
+            auto record = records.substr(space + 1, length - space - 2);
+            if (record.starts_with("path=")) path = record.substr(5);
+            records.remove_prefix(length);
+        }
+        return path;
+    }
+
+    bool readTar(
+        Source& source,
+        std::filesystem::path const& path,
+        std::function<bool(std::string_view name)> const& wanted,
+        std::function<void(std::string name, std::vector<char> contents)> const& onMember
+    ) {
+        auto const fail = [&](std::string_view reason) {
+            std::println(std::cerr, "Failed to read archive {}: {}", path.string(), source.failed() ? "read error" : reason);
+            return false;
+        };
+
+        // names carried by the GNU long name or the pax header preceding a member
+        std::string longName;
+        std::string extendedPath;
+
+        TarHeader header;
+        while (true) {
+            auto headerRead = source.readFully(reinterpret_cast<char*>(&header), BLOCK_SIZE);
+            if (headerRead == 0 && !source.failed()) return true; // no end-of-archive blocks
+            if (headerRead != BLOCK_SIZE) return fail("unexpected end of archive");
+            if (isZeroBlock(header)) return true;
+            if (!checksumValid(header)) return fail("invalid header");
+
+            auto size = fieldNumber(header.size);
+            if (!size || *size > std::numeric_limits<uint64_t>::max() - BLOCK_SIZE) return fail("invalid member size");
+            if (auto left = source.remaining(); left && *size > *left) return fail("unexpected end of archive");
+            auto padding = (BLOCK_SIZE - *size % BLOCK_SIZE) % BLOCK_SIZE;
+
+            auto const readMetadata = [&](std::string& out) {
+                if (*size > MAX_METADATA_SIZE) return false;
+                out.resize(*size);
+                return source.readFully(out.data(), out.size()) == out.size() && source.skip(padding);
+            };
+
+            switch (header.typeflag) {
+                case 'L': { // GNU long name of the next member
+                    if (!readMetadata(longName)) return fail("invalid long name");
+                    if (auto nul = longName.find('\0'); nul != std::string::npos) longName.resize(nul);
+                    break;
+                }
+
+                case 'x': { // pax extended header of the next member
+                    std::string records;
+                    if (!readMetadata(records)) return fail("invalid extended header");
+                    extendedPath = paxPath(records);
+                    break;
+                }
+
+                case '0':
+                case '\0':
+                case '7': { // regular file
+                    auto name = !longName.empty() ? std::move(longName)
+                        : !extendedPath.empty() ? std::move(extendedPath) : memberName(header);
+                    longName.clear();
+                    extendedPath.clear();
+
+                    if (!wanted(name)) {
+                        if (!source.skip(*size + padding)) return fail("unexpected end of archive");
+                        break;
+                    }
+
+                    std::vector<char> contents;
+                    if (!source.readGrowing(contents, *size) || !source.skip(padding)) {
+                        return fail("unexpected end of archive");
+                    }
+                    onMember(std::move(name), std::move(contents));
+                    break;
+                }
+
+                default: { // directories, links, devices, global headers
+                    longName.clear();
+                    extendedPath.clear();
+                    if (!source.skip(*size + padding)) return fail("unexpected end of archive");
+                    break;
+                }
+            }
+        }
+    }
+}
+
+bool isArchive(std::filesystem::path const& path) {
+    return compressionOf(path) != Compression::NotArchive;
+}
+
+bool readArchive(
+    std::filesystem::path const& path,
+    std::function<bool(std::string_view name)> const& wanted,
+    std::function<void(std::string name, std::vector<char> contents)> const& onMember
+) {
+    auto source = openSource(path);
+    if (!source) return false;
+    if (!source->isOpen()) {
+        std::println(std::cerr, "Failed to open file: {}", path.string());
+        return false;
+    }
+    return readTar(*source, path, wanted, onMember);
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Reading source files straight out of tar archives, plain or compressed with gzip or zstd,
+// without unpacking them to disk. Compression support depends on the libraries found at configure
+// time (TASK3_HAVE_ZLIB, TASK3_HAVE_ZSTD).
+
+// true for .tar, .tar.gz, .tgz and .tar.zst paths
+[[nodiscard]] bool isArchive(std::filesystem::path const& path);
+
+// Streams the archive and calls onMember with the name and contents of every regular file for
+// which wanted(name) returns true, in archive order. The contents of other members are skipped.
+// Returns false if the archive cannot be read or is malformed, members read until then are kept.
+bool readArchive(
+    std::filesystem::path const& path,
+    std::function<bool(std::string_view name)> const& wanted,
+    std::function<void(std::string name, std::vector<char> contents)> const& onMember
+);
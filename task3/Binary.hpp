@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Integers in the binary files task3 writes are little-endian whatever the host byte order,
+// so the files can move between machines.
+
+inline void appendLittleEndian(std::string& out, uint64_t value, size_t bytes = 8) {
+    for (size_t i = 0; i < bytes; ++i) out += static_cast<char>(value >> (8 * i));
+}
+
+inline uint64_t readLittleEndian(char const* data, size_t bytes = 8) {
+    uint64_t value = 0;
+    for (size_t i = bytes; i > 0; --i) value = value << 8 | static_cast<unsigned char>(data[i - 1]);
+    return value;
+}
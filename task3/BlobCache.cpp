@@ -0,0 +1,100 @@
+#include "BlobCache.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <print>
+#include <string>
+#include <string_view>
+
+#include "Binary.hpp"
+
+namespace {
+    // bump the version whenever the classifier counts lines differently
+    constexpr std::string_view CACHE_HEADER{"T3BLOBS\x01", 8};
+
+    // object name followed by the blank, comment and code line counts as little-endian 64-bit numbers
+    constexpr size_t RECORD_SIZE = 20 + 3 * 8;
+}
+
+bool BlobCache::attach(std::filesystem::path const& path) {
+    std::lock_guard lock(m_mutex);
+    m_path = path;
+
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) {
+        m_rewrite = true;
+        return true;
+    }
+
+    std::ifstream file;
+    if (std::filesystem::is_regular_file(path, ec)) file.open(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::println(std::cerr, "Failed to open file: {}", path.string());
+        return false;
+    }
+    std::string contents(std::istreambuf_iterator<char>(file), {});
+    if (!contents.starts_with(CACHE_HEADER)) {
+        m_rewrite = true;
+        return true;
+    }
+
+    // a record cut short by an interrupted run is dropped
+    size_t const records = (contents.size() - CACHE_HEADER.size()) / RECORD_SIZE;
+    m_rewrite = contents.size() != CACHE_HEADER.size() + records * RECORD_SIZE;
+    for (size_t i = 0; i < records; ++i) {
+        auto record = contents.data() + CACHE_HEADER.size() + i * RECORD_SIZE;
+        GitObjectId id;
+        std::copy_n(record, id.bytes.size(), id.bytes.data());
+        FileInfo info;
+        info.blankLines = readLittleEndian(record + 20);
+        info.commentLines = readLittleEndian(record + 28);
+        info.codeLines = readLittleEndian(record + 36);
+        m_infos.emplace(id, info);
+    }
+    if (m_rewrite) {
+        m_unsaved.assign(m_infos.begin(), m_infos.end());
+    }
+    return true;
+}
+
+std::optional<FileInfo> BlobCache::find(GitObjectId const& id) const {
+    std::lock_guard lock(m_mutex);
+    auto it = m_infos.find(id);
+    if (it == m_infos.end()) return std::nullopt;
+    return it->second;
+}
+
+void BlobCache::insert(GitObjectId const& id, FileInfo const& info) {
+    std::lock_guard lock(m_mutex);
+    if (m_infos.emplace(id, info).second && !m_path.empty()) {
+        m_unsaved.emplace_back(id, info);
+    }
+}
+
+bool BlobCache::save() {
+    std::lock_guard lock(m_mutex);
+    if (m_path.empty() || (m_unsaved.empty() && !m_rewrite)) return true;
+
+    std::string out;
+    out.reserve(CACHE_HEADER.size() + m_unsaved.size() * RECORD_SIZE);
+    if (m_rewrite) out += CACHE_HEADER;
+    for (auto const& [id, info] : m_unsaved) {
+        out.append(reinterpret_cast<char const*>(id.bytes.data()), id.bytes.size());
+        appendLittleEndian(out, info.blankLines);
+        appendLittleEndian(out, info.commentLines);
+        appendLittleEndian(out, info.codeLines);
+    }
+
+    std::ofstream file(m_path, std::ios::binary | (m_rewrite ? std::ios::trunc : std::ios::app));
+    if (!file || !file.write(out.data(), static_cast<std::streamsize>(out.size()))) {
+        std::println(std::cerr, "Failed to write blob cache: {}", m_path.string());
+        return false;
+    }
+    m_unsaved.clear();
+    m_rewrite = false;
+    return true;
+}
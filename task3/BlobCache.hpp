@@ -0,0 +1,32 @@
+#pragma once
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Analyzer.hpp"
+#include "GitRepository.hpp"
+
+// Line counts of git blobs by object name. A blob's counts never change, so a blob shared by
+// many paths or revisions is analyzed once. With a file attached the cache outlives the process:
+// a scan of the next revision only analyzes the blobs that changed. Thread-safe.
+class BlobCache {
+public:
+    // Reads the entries of the cache file, if it exists, and appends new entries to it on save().
+    // A file written by another version of the analyzer is ignored and rewritten.
+    bool attach(std::filesystem::path const& path);
+
+    [[nodiscard]] std::optional<FileInfo> find(GitObjectId const& id) const;
+    void insert(GitObjectId const& id, FileInfo const& info);
+
+    bool save();
+
+private:
+    mutable std::mutex m_mutex;
+    std::unordered_map<GitObjectId, FileInfo> m_infos;
+    std::vector<std::pair<GitObjectId, FileInfo>> m_unsaved;
+    std::filesystem::path m_path;
+    bool m_rewrite = false;
+};
@@ -0,0 +1,325 @@
+#include "CompileCommands.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <print>
+#include <string>
+#include <unordered_set>
+
+namespace {
+    // Just enough JSON for compilation databases: strings are decoded, any other value is skipped.
+    class JsonReader {
+    public:
+        explicit JsonReader(std::string_view text) : m_text(text) {}
+
+        bool consume(char expected) {
+            skipWhitespace();
+            if (m_pos >= m_text.size() || m_text[m_pos] != expected) return false;
+            ++m_pos;
+            return true;
+        }
+
+        [[nodiscard]] char peek() {
+            skipWhitespace();
+            return m_pos < m_text.size() ? m_text[m_pos] : '\0';
+        }
+
+        // Calls onElement() for every element of an array, or onMember(key) for every member of an
+        // object. The callbacks must read the value.
+        bool array(std::function<bool()> const& onElement) {
+            if (!consume('[')) return false;
+            if (consume(']')) return true;
+            do {
+                if (!onElement()) return false;
+            } while (consume(','));
+            return consume(']');
+        }
+
+        bool object(std::function<bool(std::string const& key)> const& onMember) {
+            if (!consume('{')) return false;
+            if (consume('}')) return true;
+            do {
+                std::string key;
+                if (!string(key) || !consume(':') || !onMember(key)) return false;
+            } while (consume(','));
+            return consume('}');
+        }
+
+        bool string(std::string& out) {
+            if (!consume('"')) return false;
+            out.clear();
+            while (m_pos < m_text.size()) {
+                char ch = m_text[m_pos++];
+                if (ch == '"') return true;
+                if (ch != '\\') {
+                    out += ch;
+                    continue;
+                }
+                if (m_pos >= m_text.size()) return false;
+                switch (char escaped = m_text[m_pos++]) {
+                    case 'b': out += '\b'; break;
+                    case 'f': out += '\f'; break;
+                    case 'n': out += '\n'; break;
+                    case 'r': out += '\r'; break;
+                    case 't': out += '\t'; break;
+                    case 'u': {
+                        auto codePoint = hex4();
+                        if (!codePoint) return false;
+                        // a high surrogate is followed by the low one
+                        if (*codePoint >= 0xd800 && *codePoint < 0xdc00 && m_text.substr(m_pos, 2) == "\\u") {
+                            m_pos += 2;
+                            auto low = hex4();
+                            if (!low || *low < 0xdc00 || *low >= 0xe000) return false;
+                            *codePoint = 0x10000 + ((*codePoint - 0xd800) << 10) + (*low - 0xdc00);
+                        }
+                        appendUtf8(out, *codePoint);
+                        break;
+                    }
+                    default: out += escaped; break; // \" \\ \/
+                }
+            }
+            return false;
+        }
+
+        bool skipValue() {
+            switch (peek()) {
+                case '{': return object([this](std::string const&) { return skipValue(); });
+                case '[': return array([this] { return skipValue(); });
+                case '"': {
+                    std::string ignored;
+                    return string(ignored);
+                }
+                default: {
+                    // number, true, false or null
+                    auto start = m_pos;
+                    while (m_pos < m_text.size() && std::string_view(",]} \t\r\n").find(m_text[m_pos]) == std::string_view::npos) {
+                        ++m_pos;
+                    }
+                    return m_pos > start;
+                }
+            }
+        }
+
+    private:
+        void skipWhitespace() {
+            while (m_pos < m_text.size() && std::string_view(" \t\r\n").find(m_text[m_pos]) != std::string_view::npos) {
+                ++m_pos;
+            }
+        }
+
+        std::optional<uint32_t> hex4() {
+            if (m_text.size() - m_pos < 4) return std::nullopt;
+            uint32_t value = 0;
+            for (int i = 0; i < 4; ++i) {
+                char ch = m_text[m_pos++];
+                value <<= 4;
+                if (ch >= '0' && ch <= '9') value |= ch - '0';
+                else if (ch >= 'a' && ch <= 'f') value |= ch - 'a' + 10;
+                else if (ch >= 'A' && ch <= 'F') value |= ch - 'A' + 10;
+                else return std::nullopt;
+            }
+            return value;
+        }
+
+        static void appendUtf8(std::string& out, uint32_t codePoint) {
+            if (codePoint < 0x80) {
+                out += static_cast<char>(codePoint);
+            } else if (codePoint < 0x800) {
+                out += static_cast<char>(0xc0 | codePoint >> 6);
+                out += static_cast<char>(0x80 | (codePoint & 0x3f));
+            } else if (codePoint < 0x10000) {
+                out += static_cast<char>(0xe0 | codePoint >> 12);
+                out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+                out += static_cast<char>(0x80 | (codePoint & 0x3f));
+            } else {
+                out += static_cast<char>(0xf0 | codePoint >> 18);
+                out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f));
+                out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+                out += static_cast<char>(0x80 | (codePoint & 0x3f));
+            }
+        }
+
+        std::string_view m_text;
+        size_t m_pos = 0;
+    };
+
+    // splits a "command" entry the way a POSIX shell would, quotes and backslashes included
+    std::vector<std::string> splitCommand(std::string_view command) {
+        std::vector<std::string> arguments;
+        std::string current;
+        bool inArgument = false;
+        char quote = '\0';
+        for (size_t i = 0; i < command.size(); ++i) {
+            char ch = command[i];
+            if (quote == '\'') {
+                if (ch == '\'') quote = '\0';
+                else current += ch;
+            } else if (quote == '"') {
+                if (ch == '"') quote = '\0';
+                else if (ch == '\\' && i + 1 < command.size() && std::string_view("\"\\$`").find(command[i + 1]) != std::string_view::npos) current += command[++i];
+                else current += ch;
+            } else if (ch == '\'' || ch == '"') {
+                quote = ch;
+                inArgument = true;
+            } else if (ch == '\\' && i + 1 < command.size()) {
+                current += command[++i];
+                inArgument = true;
+            } else if (ch == ' ' || ch == '\t' || ch == '\n') {
+                if (inArgument) arguments.push_back(std::move(current));
+                current.clear();
+                inArgument = false;
+            } else {
+                current += ch;
+                inArgument = true;
+            }
+        }
+        if (inArgument) arguments.push_back(std::move(current));
+        return arguments;
+    }
+
+    // picks the include directories out of a command line, relative ones are relative to directory
+    void addIncludeDirs(CompileCommand& command, std::vector<std::string> const& arguments,
+                        std::filesystem::path const& directory) {
+        struct Flag {
+            std::string_view name;
+            bool quoteOnly;
+            bool clOnly; // would be taken for an absolute path on other drivers
+        };
+        static constexpr Flag FLAGS[] = {
+            {"-iquote", true, false}, {"-isystem", false, false}, {"-idirafter", false, false},
+            {"--include-directory=", false, false}, {"-I", false, false}, {"/I", false, true},
+        };
+
+        // cl.exe or clang-cl, named by a Windows path as often as by a POSIX one
+        bool clDriver = false;
+        if (!arguments.empty()) {
+            std::string driver = arguments[0].substr(arguments[0].find_last_of("/\\") + 1);
+            std::ranges::transform(driver, driver.begin(), [](unsigned char ch) { return std::tolower(ch); });
+            if (driver.ends_with(".exe")) driver.resize(driver.size() - 4);
+            clDriver = driver == "cl" || driver == "clang-cl";
+        }
+
+        for (size_t i = 1; i < arguments.size(); ++i) {
+            std::string_view argument = arguments[i];
+            for (auto const& flag : FLAGS) {
+                if ((flag.clOnly && !clDriver) || !argument.starts_with(flag.name)) continue;
+                std::string_view dir = argument.substr(flag.name.size());
+                if (dir.empty() && !flag.name.ends_with('=')) {
+                    if (i + 1 >= arguments.size()) break;
+                    dir = arguments[++i];
+                }
+                auto& dirs = flag.quoteOnly ? command.quoteDirs : command.includeDirs;
+                dirs.push_back((directory / dir).lexically_normal());
+                break;
+            }
+        }
+    }
+
+    // An entry has "directory", "file" and either "arguments" or "command"; "output" and any
+    // other member are ignored.
+    bool readEntry(JsonReader& reader, std::vector<CompileCommand>& commands,
+                   std::unordered_set<std::filesystem::path>& seen) {
+        std::string directory;
+        std::string file;
+        std::string command;
+        std::vector<std::string> arguments;
+        bool valid = reader.object([&](std::string const& key) {
+            if (key == "directory") return reader.string(directory);
+            if (key == "file") return reader.string(file);
+            if (key == "command") return reader.string(command);
+            if (key == "arguments") {
+                return reader.array([&] { return reader.string(arguments.emplace_back()); });
+            }
+            return reader.skipValue();
+        });
+        if (!valid || file.empty()) return false;
+
+        if (arguments.empty()) arguments = splitCommand(command);
+        CompileCommand entry;
+        entry.file = (std::filesystem::path(directory) / file).lexically_normal();
+        if (!seen.insert(entry.file).second) return true;
+        addIncludeDirs(entry, arguments, directory);
+        commands.push_back(std::move(entry));
+        return true;
+    }
+
+    std::optional<std::filesystem::path> existingFile(std::filesystem::path const& path) {
+        std::error_code ec;
+        if (!std::filesystem::is_regular_file(path, ec)) return std::nullopt;
+        return path.lexically_normal();
+    }
+}
+
+std::optional<std::filesystem::path> CompileCommand::resolveInclude(
+    std::string_view name, bool angled, std::filesystem::path const& includer) const {
+    std::filesystem::path relative(name);
+    if (relative.is_absolute()) return existingFile(relative);
+
+    if (!angled) {
+        if (auto found = existingFile(includer.parent_path() / relative)) return found;
+        for (auto const& dir : quoteDirs) {
+            if (auto found = existingFile(dir / relative)) return found;
+        }
+    }
+    for (auto const& dir : includeDirs) {
+        if (auto found = existingFile(dir / relative)) return found;
+    }
+    return std::nullopt;
+}
+
+std::optional<std::vector<CompileCommand>> readCompileCommands(std::filesystem::path const& path) {
+    std::error_code ec;
+    auto databasePath = std::filesystem::is_directory(path, ec) ? path / "compile_commands.json" : path;
+    std::ifstream file;
+    if (std::filesystem::is_regular_file(databasePath, ec)) file.open(databasePath, std::ios::binary);
+    if (!file.is_open()) {
+        std::println(std::cerr, "Failed to open file: {}", databasePath.string());
+        return std::nullopt;
+    }
+    std::string text(std::istreambuf_iterator<char>(file), {});
+
+    std::vector<CompileCommand> commands;
+    std::unordered_set<std::filesystem::path> seen;
+    JsonReader reader(text);
+    if (!reader.array([&] { return readEntry(reader, commands, seen); }) || reader.peek() != '\0') {
+        std::println(std::cerr, "Malformed compilation database: {}", databasePath.string());
+        return std::nullopt;
+    }
+    return commands;
+}
+
+void forEachInclude(std::span<char const> contents,
+                    std::function<void(std::string_view name, bool angled)> const& onInclude) {
+    std::string_view text(contents.data(), contents.size());
+    auto const skipBlanks = [&](size_t pos) {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t')) ++pos;
+        return pos;
+    };
+
+    size_t lineStart = 0;
+    while (lineStart < text.size()) {
+        auto lineEnd = text.find('\n', lineStart);
+        if (lineEnd == std::string_view::npos) lineEnd = text.size();
+        auto line = text.substr(0, lineEnd);
+
+        auto pos = skipBlanks(lineStart);
+        if (pos < lineEnd && line[pos] == '#') {
+            pos = skipBlanks(pos + 1);
+            auto directive = line.substr(pos);
+            for (std::string_view keyword : {"include_next", "include", "import"}) {
+                if (!directive.starts_with(keyword)) continue;
+                pos = skipBlanks(pos + keyword.size());
+                if (pos >= lineEnd || (line[pos] != '"' && line[pos] != '<')) break;
+                bool angled = line[pos] == '<';
+                auto close = line.find(angled ? '>' : '"', pos + 1);
+                if (close != std::string_view::npos) onInclude(line.substr(pos + 1, close - pos - 1), angled);
+                break;
+            }
+        }
+        lineStart = lineEnd + 1;
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// A translation unit from a compilation database (compile_commands.json) with the include
+// directories of its command line, all made absolute against the entry's directory.
+struct CompileCommand {
+    std::filesystem::path file;
+    std::vector<std::filesystem::path> quoteDirs;   // -iquote, searched for "" includes only
+    std::vector<std::filesystem::path> includeDirs; // -I, -isystem, -idirafter, /I for cl
+
+    // Finds the file an #include names the way the compiler would, without the compiler's
+    // built-in system directories: "" includes relative to the including file first, then
+    // the quote directories, then the include directories.
+    [[nodiscard]] std::optional<std::filesystem::path> resolveInclude(
+        std::string_view name, bool angled, std::filesystem::path const& includer) const;
+};
+
+// path is the database file or a build directory holding compile_commands.json.
+// Files compiled more than once are listed once, with the first command line.
+std::optional<std::vector<CompileCommand>> readCompileCommands(std::filesystem::path const& path);
+
+// Calls onInclude(name, angled) for every #include, #include_next and #import directive of a file.
+// Directives are recognized line by line without preprocessing, so conditional ones count too.
+void forEachInclude(std::span<char const> contents,
+                    std::function<void(std::string_view name, bool angled)> const& onInclude);
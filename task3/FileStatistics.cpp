@@ -0,0 +1,108 @@
+#include "FileStatistics.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <numeric>
+#include <span>
+
+namespace {
+    // more lines rank higher, then the path that sorts first
+    bool ranksHigher(size_t lines, std::filesystem::path const& path, TopFiles::Entry const& other) {
+        auto otherLines = other.second.totalLines();
+        if (lines != otherLines) return lines > otherLines;
+        return path < other.first;
+    }
+
+    // min-heap order, the front ranks lowest
+    bool heapOrder(TopFiles::Entry const& a, TopFiles::Entry const& b) {
+        return ranksHigher(a.second.totalLines(), a.first, b);
+    }
+
+    // the index of the bucket holding quantile q of all counts
+    size_t quantileBucket(std::span<uint64_t const> counts, double q) {
+        auto total = std::accumulate(counts.begin(), counts.end(), uint64_t{0});
+        if (total == 0) return 0;
+
+        // the rank of the value at q among all values, counted from 1
+        auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * static_cast<double>(total))));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            seen += counts[i];
+            if (seen >= rank) return i;
+        }
+        return counts.size() - 1;
+    }
+}
+
+void TopFiles::add(std::filesystem::path const& path, FileInfo const& info) {
+    if (m_capacity == 0) return;
+    if (m_heap.size() == m_capacity) {
+        // the path is only copied once the file makes it in
+        if (!ranksHigher(info.totalLines(), path, m_heap.front())) return;
+        std::pop_heap(m_heap.begin(), m_heap.end(), heapOrder);
+        m_heap.back() = {path, info};
+    } else {
+        m_heap.emplace_back(path, info);
+    }
+    std::push_heap(m_heap.begin(), m_heap.end(), heapOrder);
+}
+
+void TopFiles::merge(TopFiles const& other) {
+    for (auto const& [path, info] : other.m_heap) add(path, info);
+}
+
+std::vector<TopFiles::Entry> TopFiles::sorted() const {
+    auto entries = m_heap;
+    std::sort(entries.begin(), entries.end(), heapOrder);
+    return entries;
+}
+
+size_t LineHistogram::bucket(uint64_t lines) {
+    if (lines < SUB_BUCKETS) return static_cast<size_t>(lines);
+    // the position of the highest bit picks the power of two, the bits below it the sub-bucket
+    auto shift = static_cast<size_t>(std::bit_width(lines)) - std::bit_width(SUB_BUCKETS);
+    return SUB_BUCKETS * shift + static_cast<size_t>(lines >> shift);
+}
+
+uint64_t LineHistogram::lowerBound(size_t bucket) {
+    if (bucket < SUB_BUCKETS) return bucket;
+    auto shift = bucket / SUB_BUCKETS - 1;
+    return static_cast<uint64_t>(SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+}
+
+void LineHistogram::add(uint64_t lines) {
+    ++counts[bucket(lines)];
+    max = std::max(max, lines);
+}
+
+void LineHistogram::merge(LineHistogram const& other) {
+    for (size_t i = 0; i < BUCKETS; ++i) counts[i] += other.counts[i];
+    max = std::max(max, other.max);
+}
+
+uint64_t LineHistogram::count() const {
+    return std::accumulate(counts.begin(), counts.end(), uint64_t{0});
+}
+
+uint64_t LineHistogram::quantile(double q) const {
+    return std::min(max, lowerBound(quantileBucket(counts, q)));
+}
+
+void RatioHistogram::add(FileInfo const& info) {
+    auto lines = info.commentLines + info.codeLines;
+    if (lines == 0) return;
+    ++counts[std::min(BUCKETS - 1, info.commentLines * 100 / lines)];
+}
+
+void RatioHistogram::merge(RatioHistogram const& other) {
+    for (size_t i = 0; i < BUCKETS; ++i) counts[i] += other.counts[i];
+}
+
+uint64_t RatioHistogram::count() const {
+    return std::accumulate(counts.begin(), counts.end(), uint64_t{0});
+}
+
+size_t RatioHistogram::quantile(double q) const {
+    return quantileBucket(counts, q);
+}
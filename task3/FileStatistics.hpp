@@ -0,0 +1,68 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <utility>
+#include <vector>
+
+#include "Analyzer.hpp"
+
+// The files with the most lines, kept in a heap bounded by capacity however many files are added.
+// Files with as many lines are ranked by path, so the tops of the parts of a scan merge into the
+// top of the whole scan.
+class TopFiles {
+public:
+    using Entry = std::pair<std::filesystem::path, FileInfo>;
+
+    explicit TopFiles(size_t capacity = 0) : m_capacity(capacity) {}
+
+    void add(std::filesystem::path const& path, FileInfo const& info);
+    void merge(TopFiles const& other);
+
+    [[nodiscard]] size_t capacity() const { return m_capacity; }
+    [[nodiscard]] std::vector<Entry> const& entries() const { return m_heap; } // in heap order
+
+    // the files kept, most lines first
+    [[nodiscard]] std::vector<Entry> sorted() const;
+
+private:
+    std::vector<Entry> m_heap; // the front is the lowest ranked file kept
+    size_t m_capacity;
+};
+
+// Number of files by line count. Counts below SUB_BUCKETS have a bucket each, above that every
+// power of two is split into SUB_BUCKETS buckets, so a percentile read from the buckets is off by
+// less than 1/SUB_BUCKETS of its value. Histograms merge by adding up their buckets.
+struct LineHistogram {
+    static constexpr size_t SUB_BUCKETS = 16;
+    static constexpr size_t BUCKETS = SUB_BUCKETS + (64 - 4) * SUB_BUCKETS; // 4 = log2(SUB_BUCKETS)
+
+    std::array<uint64_t, BUCKETS> counts{};
+    uint64_t max = 0;
+
+    static size_t bucket(uint64_t lines);
+    static uint64_t lowerBound(size_t bucket);
+
+    void add(uint64_t lines);
+    void merge(LineHistogram const& other);
+    [[nodiscard]] uint64_t count() const;
+
+    // the lowest line count of the bucket holding quantile q, from 0 to 1
+    [[nodiscard]] uint64_t quantile(double q) const;
+};
+
+// Number of files by the percentage of comment lines among the lines that are not blank.
+// Files without any such line are not counted.
+struct RatioHistogram {
+    static constexpr size_t BUCKETS = 100; // one per percent, 100% goes with 99%
+
+    std::array<uint64_t, BUCKETS> counts{};
+
+    void add(FileInfo const& info);
+    void merge(RatioHistogram const& other);
+    [[nodiscard]] uint64_t count() const;
+
+    // the percentage at quantile q, from 0 to 1, rounded down
+    [[nodiscard]] size_t quantile(double q) const;
+};
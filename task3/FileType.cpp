@@ -0,0 +1,27 @@
+#include "FileType.hpp"
+
+#include <unordered_map>
+
+FileType getFileType(std::filesystem::path const& path) {
+    if (!path.has_extension()) return FileType::Unknown;
+
+    static std::unordered_map<std::string_view, FileType> const extensionMap = {
+        {".cpp", FileType::Cpp},
+        {".cxx", FileType::Cpp},
+        {".cc", FileType::Cpp},
+        {".hpp", FileType::CppHeader},
+        {".hxx", FileType::CppHeader},
+        {".hh", FileType::CppHeader},
+        {".c", FileType::C},
+        {".h", FileType::CHeader},
+        {".mm", FileType::ObjectiveCpp},
+    };
+
+    auto ext = path.extension().string();
+    auto it = extensionMap.find(ext);
+    if (it != extensionMap.end()) {
+        return it->second;
+    }
+
+    return FileType::Unknown;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <filesystem>
+#include <string_view>
+
+enum class FileType {
+    Unknown,
+    Cpp,          // .cpp, .cxx, .cc
+    CppHeader,    // .hpp, .hxx, .hh
+    C,            // .c
+    CHeader,      // .h
+    ObjectiveCpp, // .mm
+};
+
+constexpr std::string_view fileTypeToString(FileType type) {
+    switch (type) {
+        case FileType::Unknown: return "Unknown";
+        case FileType::Cpp: return "C++";
+        case FileType::CppHeader: return "C++ Header";
+        case FileType::C: return "C";
+        case FileType::CHeader: return "C Header";
+        case FileType::ObjectiveCpp: return "Objective-C++";
+        default: return "Invalid Type";
+    }
+}
+
+// the type of a source file by its extension, Unknown for files that are not analyzed
+FileType getFileType(std::filesystem::path const& path);
@@ -0,0 +1,631 @@
+#include "GitRepository.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <iostream>
+#include <iterator>
+#include <print>
+#include <span>
+
+#ifdef TASK3_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+    constexpr int MAX_LINK_DEPTH = 8;      // symbolic refs, alternates, tags of tags
+    constexpr int MAX_DELTA_DEPTH = 10000; // git itself writes chains of at most 4095
+    constexpr size_t MAX_BASE_CACHE_BYTES = 64 * 1024 * 1024; // 64 MiB per pack
+
+    // pack entry types next to the object types
+    constexpr uint8_t PACK_OFS_DELTA = 6;
+    constexpr uint8_t PACK_REF_DELTA = 7;
+
+    constexpr uint32_t PACK_INDEX_MAGIC = 0xff744f63; // "\377tOc"
+    constexpr size_t PACK_INDEX_HEADER_SIZE = 8 + 256 * 4;
+
+    std::optional<std::string> readTextFile(std::filesystem::path const& path) {
+        std::error_code ec;
+        if (!std::filesystem::is_regular_file(path, ec)) return std::nullopt;
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return std::nullopt;
+        return std::string(std::istreambuf_iterator<char>(file), {});
+    }
+
+    std::string_view trim(std::string_view text) {
+        auto first = text.find_first_not_of(" \t\r\n");
+        if (first == std::string_view::npos) return {};
+        auto last = text.find_last_not_of(" \t\r\n");
+        return text.substr(first, last - first + 1);
+    }
+
+    uint64_t readBigEndian(char const* data, size_t bytes) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < bytes; ++i) value = value << 8 | static_cast<unsigned char>(data[i]);
+        return value;
+    }
+
+    std::optional<GitRepository::ObjectType> objectType(std::string_view name) {
+        if (name == "commit") return GitRepository::ObjectType::Commit;
+        if (name == "tree") return GitRepository::ObjectType::Tree;
+        if (name == "blob") return GitRepository::ObjectType::Blob;
+        if (name == "tag") return GitRepository::ObjectType::Tag;
+        return std::nullopt;
+    }
+
+    // Applies a git delta: the sizes of base and result, then instructions that either copy
+    // a range of the base or insert literal bytes.
+    std::optional<std::vector<char>> applyDelta(std::span<char const> base, std::span<char const> delta) {
+        size_t pos = 0;
+        auto const readSize = [&]() -> std::optional<uint64_t> {
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                if (pos >= delta.size()) return std::nullopt;
+                auto byte = static_cast<unsigned char>(delta[pos++]);
+                value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                if (!(byte & 0x80)) return value;
+            }
+            return std::nullopt;
+        };
+
+        auto baseSize = readSize();
+        auto resultSize = readSize();
+        if (!baseSize || !resultSize || *baseSize != base.size()) return std::nullopt;
+
+        // the sizes may be corrupt, the result grows with what the instructions produce
+        std::vector<char> result;
+        result.reserve(static_cast<size_t>(std::min<uint64_t>(*resultSize, base.size() + delta.size())));
+        while (pos < delta.size()) {
+            auto op = static_cast<unsigned char>(delta[pos++]);
+            if (op & 0x80) {
+                // copy, the low bits tell which offset and size bytes follow
+                uint64_t offset = 0;
+                uint64_t size = 0;
+                for (int i = 0; i < 7; ++i) {
+                    if (!(op & (1 << i))) continue;
+                    if (pos >= delta.size()) return std::nullopt;
+                    auto byte = static_cast<uint64_t>(static_cast<unsigned char>(delta[pos++]));
+                    if (i < 4) offset |= byte << (8 * i);
+                    else size |= byte << (8 * (i - 4));
+                }
+                if (size == 0) size = 0x10000;
+                if (offset > base.size() || size > base.size() - offset) return std::nullopt;
+                if (size > *resultSize - result.size()) return std::nullopt;
+                result.insert(result.end(), base.begin() + offset, base.begin() + offset + size);
+            } else if (op != 0) {
+                // insert the next op bytes
+                if (op > delta.size() - pos || op > *resultSize - result.size()) return std::nullopt;
+                result.insert(result.end(), delta.begin() + pos, delta.begin() + pos + op);
+                pos += op;
+            } else {
+                return std::nullopt; // reserved
+            }
+        }
+
+        if (result.size() != *resultSize) return std::nullopt;
+        return result;
+    }
+
+#ifdef TASK3_HAVE_ZLIB
+    // inflates a zlib stream read from the current position of a file
+    class Inflater {
+    public:
+        explicit Inflater(std::istream& input) : m_input(input) {
+            m_initialized = inflateInit(&m_stream) == Z_OK;
+            if (!m_initialized) m_result = Z_STREAM_ERROR;
+        }
+
+        Inflater(Inflater const&) = delete;
+        Inflater& operator=(Inflater const&) = delete;
+
+        ~Inflater() {
+            if (m_initialized) inflateEnd(&m_stream);
+        }
+
+        // inflates up to size bytes, fewer only at the end of the stream or on error
+        size_t read(char* data, size_t size) {
+            m_stream.next_out = reinterpret_cast<Bytef*>(data);
+            m_stream.avail_out = static_cast<uInt>(size);
+            while (m_stream.avail_out > 0 && m_result == Z_OK) {
+                if (m_stream.avail_in == 0) {
+                    m_input.read(m_buffer.data(), m_buffer.size());
+                    auto n = m_input.gcount();
+                    if (n == 0) {
+                        m_result = Z_DATA_ERROR; // truncated
+                        break;
+                    }
+                    m_stream.next_in = reinterpret_cast<Bytef*>(m_buffer.data());
+                    m_stream.avail_in = static_cast<uInt>(n);
+                }
+                m_result = inflate(&m_stream, Z_NO_FLUSH);
+                if (m_result == Z_BUF_ERROR && m_stream.avail_in == 0) m_result = Z_OK; // wants more input
+            }
+            return size - m_stream.avail_out;
+        }
+
+        // true if the stream ends exactly after what was read so far
+        bool finish() {
+            char extra;
+            return read(&extra, 1) == 0 && m_result == Z_STREAM_END;
+        }
+
+    private:
+        std::istream& m_input;
+        z_stream m_stream{};
+        std::array<char, 4096> m_buffer;
+        bool m_initialized = false;
+        int m_result = Z_OK;
+    };
+
+    // Inflates the rest of a stream into data until it holds size bytes, and checks that the stream
+    // ends there. The size comes from a header that may be corrupt, so data grows as the bytes
+    // arrive instead of being allocated up front.
+    bool inflateInto(Inflater& inflater, std::vector<char>& data, uint64_t size) {
+        constexpr size_t MIN_CHUNK = 64 * 1024; // 64 KiB
+        while (data.size() < size) {
+            auto chunk = static_cast<size_t>(std::min<uint64_t>(size - data.size(), std::max(data.size(), MIN_CHUNK)));
+            auto done = data.size();
+            data.resize(done + chunk);
+            if (inflater.read(data.data() + done, chunk) != chunk) return false;
+        }
+        return inflater.finish();
+    }
+
+    std::optional<std::vector<char>> inflateExactly(std::istream& input, uint64_t size) {
+        Inflater inflater(input);
+        std::vector<char> data;
+        if (!inflateInto(inflater, data, size)) return std::nullopt;
+        return data;
+    }
+#endif
+}
+
+std::optional<GitObjectId> GitObjectId::fromHex(std::string_view hex) {
+    GitObjectId id;
+    if (hex.size() != id.bytes.size() * 2) return std::nullopt;
+    auto const digit = [](char ch) -> int {
+        if (ch >= '0' && ch <= '9') return ch - '0';
+        if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+        if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+        return -1;
+    };
+    for (size_t i = 0; i < id.bytes.size(); ++i) {
+        int high = digit(hex[2 * i]);
+        int low = digit(hex[2 * i + 1]);
+        if (high < 0 || low < 0) return std::nullopt;
+        id.bytes[i] = static_cast<uint8_t>(high << 4 | low);
+    }
+    return id;
+}
+
+std::string GitObjectId::hex() const {
+    constexpr std::string_view DIGITS = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(bytes.size() * 2);
+    for (auto byte : bytes) {
+        hex += DIGITS[byte >> 4];
+        hex += DIGITS[byte & 0xf];
+    }
+    return hex;
+}
+
+std::optional<GitRepository> GitRepository::open(std::filesystem::path const& path) {
+    std::error_code ec;
+    GitRepository repo;
+    auto dotGit = path / ".git";
+    if (std::filesystem::is_directory(dotGit, ec)) {
+        repo.m_gitDir = dotGit;
+    } else if (auto link = readTextFile(dotGit)) {
+        // linked worktrees and submodules have a "gitdir: <path>" file instead
+        auto target = trim(*link);
+        if (!target.starts_with("gitdir:")) {
+            std::println(std::cerr, "Invalid .git file in {}", path.string());
+            return std::nullopt;
+        }
+        repo.m_gitDir = path / trim(target.substr(7));
+    } else if (std::filesystem::exists(path / "HEAD", ec)
+        && (std::filesystem::is_directory(path / "objects", ec) || std::filesystem::exists(path / "commondir", ec))) {
+        repo.m_gitDir = path; // bare repository or a .git directory
+    } else {
+        std::println(std::cerr, "Not a git repository: {}", path.string());
+        return std::nullopt;
+    }
+
+    repo.m_commonDir = repo.m_gitDir;
+    if (auto common = readTextFile(repo.m_gitDir / "commondir")) {
+        repo.m_commonDir = (repo.m_gitDir / trim(*common)).lexically_normal();
+    }
+
+#ifndef TASK3_HAVE_ZLIB
+    std::println(std::cerr, "Cannot read {}: built without zlib support", path.string());
+    return std::nullopt;
+#else
+    if (!repo.loadObjectDirectory(repo.m_commonDir / "objects", 0)) return std::nullopt;
+    return repo;
+#endif
+}
+
+bool GitRepository::loadObjectDirectory(std::filesystem::path const& objects, int depth) {
+    std::error_code ec;
+    if (!std::filesystem::is_directory(objects, ec)) {
+        std::println(std::cerr, "Missing git object directory: {}", objects.string());
+        return false;
+    }
+    m_objectDirs.push_back(objects);
+
+    for (auto const& entry : std::filesystem::directory_iterator(objects / "pack", ec)) {
+        if (entry.path().extension() == ".idx" && !loadPack(entry.path())) return false;
+    }
+
+    // objects borrowed from other repositories, one directory per line
+    if (auto alternates = readTextFile(objects / "info" / "alternates")) {
+        std::string_view lines = *alternates;
+        while (!lines.empty()) {
+            auto newline = lines.find('\n');
+            auto line = trim(lines.substr(0, newline));
+            lines.remove_prefix(newline == std::string_view::npos ? lines.size() : newline + 1);
+            if (line.empty() || line.starts_with('#')) continue;
+            if (depth >= MAX_LINK_DEPTH) {
+                std::println(std::cerr, "Too many nested alternates in {}", objects.string());
+                return false;
+            }
+            if (!loadObjectDirectory((objects / line).lexically_normal(), depth + 1)) return false;
+        }
+    }
+    return true;
+}
+
+// Loads a version 2 pack index: magic, version, 256 fanout counts, the sorted object names,
+// their CRCs, their 31-bit offsets and the 64-bit offsets those point to for packs over 2 GiB.
+bool GitRepository::loadPack(std::filesystem::path const& indexPath) {
+    auto index = readTextFile(indexPath);
+    if (!index || index->size() < PACK_INDEX_HEADER_SIZE
+        || readBigEndian(index->data(), 4) != PACK_INDEX_MAGIC || readBigEndian(index->data() + 4, 4) != 2) {
+        std::println(std::cerr, "Unsupported pack index: {}", indexPath.string());
+        return false;
+    }
+
+    Pack pack;
+    pack.path = indexPath;
+    pack.path.replace_extension(".pack");
+    for (size_t i = 0; i < pack.fanout.size(); ++i) {
+        pack.fanout[i] = static_cast<uint32_t>(readBigEndian(index->data() + 8 + 4 * i, 4));
+        // the counts are cumulative, readObject searches between neighbouring ones
+        if (i > 0 && pack.fanout[i] < pack.fanout[i - 1]) {
+            std::println(std::cerr, "Invalid pack index: {}", indexPath.string());
+            return false;
+        }
+    }
+
+    size_t const count = pack.fanout.back();
+    if (index->size() < PACK_INDEX_HEADER_SIZE + count * (20 + 4 + 4) + 2 * 20) {
+        std::println(std::cerr, "Truncated pack index: {}", indexPath.string());
+        return false;
+    }
+    auto const names = index->data() + PACK_INDEX_HEADER_SIZE;
+    auto const offsets = names + count * (20 + 4);
+    auto const largeOffsets = offsets + count * 4;
+    // the checksums of the pack and of the index end the file
+    size_t const largeCount = (index->size() - PACK_INDEX_HEADER_SIZE - count * (20 + 4 + 4) - 2 * 20) / 8;
+
+    pack.ids.resize(count);
+    pack.offsets.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        std::memcpy(pack.ids[i].bytes.data(), names + 20 * i, 20);
+        uint64_t offset = readBigEndian(offsets + 4 * i, 4);
+        if (offset & 0x80000000) {
+            offset &= 0x7fffffff;
+            if (offset >= largeCount) {
+                std::println(std::cerr, "Invalid pack index: {}", indexPath.string());
+                return false;
+            }
+            offset = readBigEndian(largeOffsets + 8 * offset, 8);
+        }
+        pack.offsets[i] = offset;
+    }
+
+    pack.file.open(pack.path, std::ios::binary);
+    if (!pack.file) {
+        std::println(std::cerr, "Failed to open file: {}", pack.path.string());
+        return false;
+    }
+    m_packs.push_back(std::move(pack));
+    return true;
+}
+
+std::optional<GitObjectId> GitRepository::readRef(std::string const& name, int depth) const {
+    // HEAD and the other pseudo refs belong to the worktree, refs/ is shared
+    auto const& dir = name.starts_with("refs/") ? m_commonDir : m_gitDir;
+    if (auto text = readTextFile(dir / name)) {
+        auto value = trim(*text);
+        if (value.starts_with("ref:")) {
+            if (depth >= MAX_LINK_DEPTH) return std::nullopt;
+            return readRef(std::string(trim(value.substr(4))), depth + 1);
+        }
+        return GitObjectId::fromHex(value.substr(0, 40)); // FETCH_HEAD has more after the name
+    }
+
+    // "<name> <ref>" lines, "^<name>" lines peel the tag above them
+    if (auto packed = readTextFile(m_commonDir / "packed-refs")) {
+        std::string_view lines = *packed;
+        while (!lines.empty()) {
+            auto newline = lines.find('\n');
+            auto line = trim(lines.substr(0, newline));
+            lines.remove_prefix(newline == std::string_view::npos ? lines.size() : newline + 1);
+            if (line.size() > 41 && line[40] == ' ' && line.substr(41) == name) {
+                return GitObjectId::fromHex(line.substr(0, 40));
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<GitObjectId> GitRepository::resolve(std::string_view revision) {
+    auto suffixes = revision.find_first_of("~^");
+    auto name = revision.substr(0, suffixes);
+
+    std::optional<GitObjectId> id = GitObjectId::fromHex(name);
+    // the order git uses to disambiguate a short ref name
+    std::string rev(name);
+    for (auto const& ref : {rev, "refs/" + rev, "refs/tags/" + rev, "refs/heads/" + rev,
+                            "refs/remotes/" + rev, "refs/remotes/" + rev + "/HEAD"}) {
+        if (id) break;
+        id = readRef(ref, 0);
+    }
+
+    // ~<n> is the n-th first-parent ancestor, ^<n> the n-th parent, both default to 1
+    auto rest = suffixes == std::string_view::npos ? std::string_view{} : revision.substr(suffixes);
+    while (id && !rest.empty()) {
+        char op = rest.front();
+        rest.remove_prefix(1);
+        size_t n = 1;
+        auto [end, ec] = std::from_chars(rest.data(), rest.data() + rest.size(), n);
+        if (ec == std::errc{}) rest.remove_prefix(end - rest.data());
+        else if (!rest.empty() && rest.front() != '~' && rest.front() != '^') return std::nullopt;
+
+        if (op == '^') {
+            id = n == 0 ? id : parentOf(*id, n);
+        } else {
+            for (size_t i = 0; id && i < n; ++i) id = parentOf(*id, 1);
+        }
+    }
+    return id;
+}
+
+// Commits list "tree <name>", then one "parent <name>" line per parent.
+std::optional<GitObjectId> GitRepository::parentOf(GitObjectId const& commit, size_t n) {
+    auto object = readObject(commit);
+    if (!object || object->type != ObjectType::Commit) {
+        std::println(std::cerr, "Git object {} is not a commit", commit.hex());
+        return std::nullopt;
+    }
+
+    std::string_view lines(object->data.data(), object->data.size());
+    size_t parent = 0;
+    while (!lines.empty()) {
+        auto newline = lines.find('\n');
+        auto line = lines.substr(0, newline);
+        if (line.empty()) break; // the message follows the headers
+        if (line.starts_with("parent ") && ++parent == n) return GitObjectId::fromHex(line.substr(7));
+        lines.remove_prefix(newline == std::string_view::npos ? lines.size() : newline + 1);
+    }
+    std::println(std::cerr, "Commit {} has no parent {}", commit.hex(), n);
+    return std::nullopt;
+}
+
+std::optional<GitRepository::Object> GitRepository::readObject(GitObjectId const& id) {
+    return readObject(id, 0);
+}
+
+// depth counts the deltas already followed to get here, REF_DELTA bases are looked up by name
+std::optional<GitRepository::Object> GitRepository::readObject(GitObjectId const& id, int depth) {
+    for (auto& pack : m_packs) {
+        size_t first = id.bytes[0] == 0 ? 0 : pack.fanout[id.bytes[0] - 1];
+        size_t last = pack.fanout[id.bytes[0]];
+        auto begin = pack.ids.begin();
+        auto it = std::lower_bound(begin + first, begin + last, id);
+        if (it != begin + last && *it == id) return readPacked(pack, pack.offsets[it - begin], depth);
+    }
+
+    return readLoose(id);
+}
+
+// A loose object is a zlib stream of "<type> <size>\0" followed by the contents.
+std::optional<GitRepository::Object> GitRepository::readLoose(GitObjectId const& id) {
+#ifdef TASK3_HAVE_ZLIB
+    auto hex = id.hex();
+    for (auto const& objects : m_objectDirs) {
+        auto path = objects / hex.substr(0, 2) / hex.substr(2);
+        std::ifstream file(path, std::ios::binary);
+        if (!file) continue;
+
+        auto const fail = [&] {
+            std::println(std::cerr, "Malformed git object file {}", path.string());
+            return std::nullopt;
+        };
+
+        Inflater inflater(file);
+        std::array<char, 32> header;
+        auto headerSize = inflater.read(header.data(), header.size());
+        std::string_view text(header.data(), headerSize);
+        auto space = text.find(' ');
+        auto nul = text.find('\0');
+        if (space == std::string_view::npos || nul == std::string_view::npos || space > nul) return fail();
+
+        auto type = objectType(text.substr(0, space));
+        size_t size = 0;
+        auto sizeText = text.substr(space + 1, nul - space - 1);
+        auto [end, ec] = std::from_chars(sizeText.data(), sizeText.data() + sizeText.size(), size);
+        if (!type || ec != std::errc{} || end != sizeText.data() + sizeText.size()) return fail();
+
+        // part of the contents came with the header
+        auto inHeader = std::min(size, headerSize - nul - 1);
+        std::vector<char> data(header.data() + nul + 1, header.data() + nul + 1 + inHeader);
+        if (!inflateInto(inflater, data, size)) return fail();
+        return Object{*type, std::move(data)};
+    }
+    std::println(std::cerr, "Missing git object {}", hex);
+#else
+    (void)id;
+#endif
+    return std::nullopt;
+}
+
+// A pack entry is a header with the type and the inflated size, for deltas followed by the base
+// as a backward offset or an object name, then the zlib stream of the contents or the delta.
+std::optional<GitRepository::Object> GitRepository::readPacked(Pack& pack, uint64_t offset, int depth) {
+#ifdef TASK3_HAVE_ZLIB
+    auto const fail = [&] {
+        std::println(std::cerr, "Malformed pack entry at {} in {}", offset, pack.path.string());
+        return std::nullopt;
+    };
+
+    auto& file = pack.file;
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(offset));
+
+    int byte = file.get();
+    if (byte == EOF) return fail();
+    auto type = static_cast<uint8_t>((byte >> 4) & 7);
+    uint64_t size = byte & 0x0f;
+    for (int shift = 4; byte & 0x80; shift += 7) {
+        byte = file.get();
+        if (byte == EOF || shift > 57) return fail();
+        size |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    }
+
+    if (type != PACK_OFS_DELTA && type != PACK_REF_DELTA) {
+        if (type < 1 || type > 4) return fail();
+        auto data = inflateExactly(file, size);
+        if (!data) return fail();
+        return Object{static_cast<ObjectType>(type), std::move(*data)};
+    }
+
+    if (depth >= MAX_DELTA_DEPTH) return fail();
+
+    // the delta is read before the base, reading the base moves the file position
+    std::optional<uint64_t> baseOffset;
+    GitObjectId baseId;
+    if (type == PACK_OFS_DELTA) {
+        byte = file.get();
+        if (byte == EOF) return fail();
+        uint64_t distance = byte & 0x7f;
+        while (byte & 0x80) {
+            byte = file.get();
+            if (byte == EOF || distance >> 56) return fail();
+            distance = ((distance + 1) << 7) | (byte & 0x7f);
+        }
+        if (distance == 0 || distance > offset) return fail();
+        baseOffset = offset - distance;
+    } else {
+        if (!file.read(reinterpret_cast<char*>(baseId.bytes.data()), baseId.bytes.size())) return fail();
+    }
+
+    auto delta = inflateExactly(file, size);
+    if (!delta) return fail();
+
+    Object const* base = nullptr;
+    std::optional<Object> refBase;
+    if (baseOffset) {
+        auto cached = pack.baseCache.find(*baseOffset);
+        if (cached == pack.baseCache.end()) {
+            auto object = readPacked(pack, *baseOffset, depth + 1);
+            if (!object) return std::nullopt;
+            // entries are dropped all at once, base stays valid until the next insert
+            if (pack.baseCacheBytes + object->data.size() > MAX_BASE_CACHE_BYTES) {
+                pack.baseCache.clear();
+                pack.baseCacheBytes = 0;
+            }
+            pack.baseCacheBytes += object->data.size();
+            cached = pack.baseCache.emplace(*baseOffset, std::move(*object)).first;
+        }
+        base = &cached->second;
+    } else {
+        refBase = readObject(baseId, depth + 1);
+        if (!refBase) return std::nullopt;
+        base = &*refBase;
+    }
+
+    auto data = applyDelta(base->data, *delta);
+    if (!data) return fail();
+    return Object{base->type, std::move(*data)};
+#else
+    (void)pack;
+    (void)offset;
+    (void)depth;
+    return std::nullopt;
+#endif
+}
+
+std::optional<GitObjectId> GitRepository::treeOf(GitObjectId id) {
+    // commits and tags start with "tree <name>" and "object <name>"
+    for (int depth = 0; depth <= MAX_LINK_DEPTH; ++depth) {
+        auto object = readObject(id);
+        if (!object) return std::nullopt;
+
+        std::string_view text(object->data.data(), object->data.size());
+        std::string_view key;
+        switch (object->type) {
+            case ObjectType::Tree: return id;
+            case ObjectType::Commit: key = "tree "; break;
+            case ObjectType::Tag: key = "object "; break;
+            default: {
+                std::println(std::cerr, "Git object {} is not a commit, tag or tree", id.hex());
+                return std::nullopt;
+            }
+        }
+
+        auto next = text.starts_with(key) ? GitObjectId::fromHex(text.substr(key.size(), 40)) : std::nullopt;
+        if (!next) {
+            std::println(std::cerr, "Malformed git object {}", id.hex());
+            return std::nullopt;
+        }
+        id = *next;
+    }
+    std::println(std::cerr, "Too many nested tags at {}", id.hex());
+    return std::nullopt;
+}
+
+bool GitRepository::forEachBlob(
+    GitObjectId const& id,
+    std::function<void(std::string const& path, GitObjectId const& blob)> const& onBlob
+) {
+    auto tree = treeOf(id);
+    return tree && walkTree(*tree, "", onBlob);
+}
+
+// A tree is a sequence of "<octal mode> <name>\0" followed by the 20-byte object name.
+bool GitRepository::walkTree(
+    GitObjectId const& tree,
+    std::string const& prefix,
+    std::function<void(std::string const& path, GitObjectId const& blob)> const& onBlob
+) {
+    auto object = readObject(tree);
+    if (!object) return false;
+    if (object->type != ObjectType::Tree) {
+        std::println(std::cerr, "Git object {} is not a tree", tree.hex());
+        return false;
+    }
+
+    std::string_view entries(object->data.data(), object->data.size());
+    while (!entries.empty()) {
+        auto space = entries.find(' ');
+        auto nul = entries.find('\0', space);
+        if (space == std::string_view::npos || nul == std::string_view::npos || entries.size() - nul - 1 < 20) {
+            std::println(std::cerr, "Malformed git tree {}", tree.hex());
+            return false;
+        }
+
+        auto mode = entries.substr(0, space);
+        auto path = prefix + std::string(entries.substr(space + 1, nul - space - 1));
+        GitObjectId child;
+        std::memcpy(child.bytes.data(), entries.data() + nul + 1, child.bytes.size());
+        entries.remove_prefix(nul + 1 + child.bytes.size());
+
+        if (mode == "40000") {
+            if (!walkTree(child, path + '/', onBlob)) return false;
+        } else if (mode.starts_with("100")) { // regular or executable file, not 120000 symlinks or 160000 submodules
+            onBlob(path, child);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <array>
+#include <compare>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// SHA-1 name of a git object
+struct GitObjectId {
+    std::array<uint8_t, 20> bytes{};
+
+    // full 40-digit hex names only
+    static std::optional<GitObjectId> fromHex(std::string_view hex);
+    [[nodiscard]] std::string hex() const;
+
+    auto operator<=>(GitObjectId const&) const = default;
+};
+
+template <>
+struct std::hash<GitObjectId> {
+    size_t operator()(GitObjectId const& id) const noexcept {
+        // the name is already a uniformly distributed hash
+        size_t value;
+        std::memcpy(&value, id.bytes.data(), sizeof(value));
+        return value;
+    }
+};
+
+// Read-only access to the object database of a local repository: loose objects, packfiles and
+// alternates, without running git. Only reading the objects needs zlib (TASK3_HAVE_ZLIB).
+// Not thread-safe, packfiles are read through one stream each.
+class GitRepository {
+public:
+    enum class ObjectType : uint8_t {
+        Commit = 1,
+        Tree = 2,
+        Blob = 3,
+        Tag = 4,
+    };
+
+    struct Object {
+        ObjectType type;
+        std::vector<char> data;
+    };
+
+    // path is a working tree, a bare repository or a .git directory
+    static std::optional<GitRepository> open(std::filesystem::path const& path);
+
+    // Resolves a full object name or a ref, as HEAD, main, v1.0 or refs/heads/main, optionally
+    // followed by ~<n> and ^<n> ancestry suffixes. Symbolic refs are followed, the result is not peeled.
+    [[nodiscard]] std::optional<GitObjectId> resolve(std::string_view revision);
+
+    // Calls onBlob(path, id) for every regular file in the tree of a commit, tag or tree, in tree order.
+    // Symlinks and submodules are skipped. Returns false if an object is missing or malformed.
+    bool forEachBlob(
+        GitObjectId const& id,
+        std::function<void(std::string const& path, GitObjectId const& blob)> const& onBlob
+    );
+
+    std::optional<Object> readObject(GitObjectId const& id);
+
+private:
+    struct Pack {
+        std::filesystem::path path;
+        std::array<uint32_t, 256> fanout{};
+        std::vector<GitObjectId> ids; // sorted, as in the index
+        std::vector<uint64_t> offsets;
+        std::ifstream file;
+        // recently inflated delta bases by offset, deltas of one chain tend to share them
+        std::unordered_map<uint64_t, Object> baseCache;
+        size_t baseCacheBytes = 0;
+    };
+
+    GitRepository() = default;
+
+    bool loadObjectDirectory(std::filesystem::path const& objects, int depth);
+    bool loadPack(std::filesystem::path const& indexPath);
+
+    std::optional<GitObjectId> readRef(std::string const& name, int depth) const;
+    std::optional<Object> readLoose(GitObjectId const& id);
+    std::optional<Object> readObject(GitObjectId const& id, int depth);
+    std::optional<Object> readPacked(Pack& pack, uint64_t offset, int depth);
+    std::optional<GitObjectId> parentOf(GitObjectId const& commit, size_t n);
+    std::optional<GitObjectId> treeOf(GitObjectId id);
+    bool walkTree(
+        GitObjectId const& tree,
+        std::string const& prefix,
+        std::function<void(std::string const& path, GitObjectId const& blob)> const& onBlob
+    );
+
+    std::filesystem::path m_gitDir;
+    std::filesystem::path m_commonDir; // differs from m_gitDir in linked worktrees
+    std::vector<std::filesystem::path> m_objectDirs;
+    std::vector<Pack> m_packs;
+};
@@ -0,0 +1,255 @@
+#include "ScanResult.hpp"
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <print>
+#include <string>
+
+#include "Binary.hpp"
+
+namespace {
+    // bump the version whenever the layout changes
+    constexpr std::string_view RESULT_HEADER{"T3SCAN\x02\x00", 8};
+
+    // Layout after the header, numbers are 8 bytes unless noted:
+    //   type count (1 byte), then per type: type (1 byte), files, blank, comment, code lines
+    //   total files, blank, comment, code lines
+    //   file count, then per file: path length (4 bytes), path, blank, comment, code lines
+    //   top file capacity, count, then per file as above
+    //   lines per file: the largest count, then the count of every bucket
+    //   comment ratio: the count of every bucket
+    constexpr size_t INFO_SIZE = 3 * 8;
+
+    void appendInfo(std::string& out, FileInfo const& info) {
+        appendLittleEndian(out, info.blankLines);
+        appendLittleEndian(out, info.commentLines);
+        appendLittleEndian(out, info.codeLines);
+    }
+
+    void appendFile(std::string& out, std::filesystem::path const& file, FileInfo const& info) {
+        auto name = file.generic_string();
+        appendLittleEndian(out, name.size(), 4);
+        out += name;
+        appendInfo(out, info);
+    }
+
+    // reads the fields in order, every read checks that the data is long enough
+    class Reader {
+    public:
+        explicit Reader(std::string_view data) : m_data(data) {}
+
+        bool number(uint64_t& value, size_t bytes = 8) {
+            if (m_data.size() < bytes) return false;
+            value = readLittleEndian(m_data.data(), bytes);
+            m_data.remove_prefix(bytes);
+            return true;
+        }
+
+        bool info(FileInfo& info) {
+            uint64_t blank = 0, comment = 0, code = 0;
+            if (!number(blank) || !number(comment) || !number(code)) return false;
+            info = {static_cast<size_t>(blank), static_cast<size_t>(comment), static_cast<size_t>(code)};
+            return true;
+        }
+
+        bool text(std::string_view& value, size_t size) {
+            if (m_data.size() < size) return false;
+            value = m_data.substr(0, size);
+            m_data.remove_prefix(size);
+            return true;
+        }
+
+        bool file(std::filesystem::path& path, FileInfo& info) {
+            uint64_t length = 0;
+            std::string_view name;
+            if (!number(length, 4) || !text(name, static_cast<size_t>(length)) || !this->info(info)) return false;
+            path = std::filesystem::path(name);
+            return true;
+        }
+
+        template <size_t N>
+        bool counts(std::array<uint64_t, N>& values) {
+            for (auto& value : values) {
+                if (!number(value)) return false;
+            }
+            return true;
+        }
+
+        [[nodiscard]] size_t remaining() const { return m_data.size(); }
+
+    private:
+        std::string_view m_data;
+    };
+}
+
+void ScanResult::add(std::filesystem::path const& path, FileType type, FileInfo const& info, bool keepFile) {
+    if (keepFile) files[path] = info;
+    top.add(path, info);
+    linesPerFile.add(info.totalLines());
+    commentRatio.add(info);
+    types[type].info += info;
+    types[type].fileCount++;
+    total += info;
+    ++totalFiles;
+}
+
+void ScanResult::merge(ScanResult const& other) {
+    for (auto const& [type, stats] : other.types) {
+        types[type].info += stats.info;
+        types[type].fileCount += stats.fileCount;
+    }
+    totalFiles += other.totalFiles;
+    total += other.total;
+    for (auto const& [path, info] : other.files) files[path] = info;
+    // per-file records hold every file, the top of the other result may be shorter than ours
+    if (!other.files.empty()) {
+        for (auto const& [path, info] : other.files) top.add(path, info);
+    } else {
+        top.merge(other.top);
+    }
+    linesPerFile.merge(other.linesPerFile);
+    commentRatio.merge(other.commentRatio);
+}
+
+bool ScanResult::hasTop(size_t count) const {
+    return !files.empty() || top.capacity() >= count || top.entries().size() == totalFiles;
+}
+
+bool writeScanResult(std::filesystem::path const& path, ScanResult const& result) {
+    std::string out(RESULT_HEADER);
+    appendLittleEndian(out, result.types.size(), 1);
+    for (auto const& [type, stats] : result.types) {
+        appendLittleEndian(out, static_cast<uint64_t>(type), 1);
+        appendLittleEndian(out, stats.fileCount);
+        appendInfo(out, stats.info);
+    }
+
+    appendLittleEndian(out, result.totalFiles);
+    appendInfo(out, result.total);
+
+    appendLittleEndian(out, result.files.size());
+    for (auto const& [file, info] : result.files) appendFile(out, file, info);
+
+    appendLittleEndian(out, result.top.capacity());
+    appendLittleEndian(out, result.top.entries().size());
+    for (auto const& [file, info] : result.top.entries()) appendFile(out, file, info);
+
+    appendLittleEndian(out, result.linesPerFile.max);
+    for (auto count : result.linesPerFile.counts) appendLittleEndian(out, count);
+    for (auto count : result.commentRatio.counts) appendLittleEndian(out, count);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file || !file.write(out.data(), static_cast<std::streamsize>(out.size()))) {
+        std::println(std::cerr, "Failed to write partial result: {}", path.string());
+        return false;
+    }
+    return true;
+}
+
+std::optional<ScanResult> readScanResult(std::filesystem::path const& path) {
+    std::error_code ec;
+    std::ifstream file;
+    if (std::filesystem::is_regular_file(path, ec)) file.open(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::println(std::cerr, "Failed to open file: {}", path.string());
+        return std::nullopt;
+    }
+    std::string contents(std::istreambuf_iterator<char>(file), {});
+    if (!std::string_view(contents).starts_with(RESULT_HEADER)) {
+        std::println(std::cerr, "Not a partial result: {}", path.string());
+        return std::nullopt;
+    }
+
+    auto const malformed = [&] {
+        std::println(std::cerr, "Malformed partial result: {}", path.string());
+        return std::nullopt;
+    };
+
+    ScanResult result;
+    Reader reader(std::string_view(contents).substr(RESULT_HEADER.size()));
+    uint64_t typeCount = 0;
+    if (!reader.number(typeCount, 1)) return malformed();
+    for (uint64_t i = 0; i < typeCount; ++i) {
+        uint64_t type = 0;
+        uint64_t fileCount = 0;
+        TypeStats stats;
+        if (!reader.number(type, 1) || type > static_cast<uint64_t>(FileType::ObjectiveCpp)
+            || !reader.number(fileCount) || !reader.info(stats.info)) {
+            return malformed();
+        }
+        stats.fileCount = static_cast<size_t>(fileCount);
+        result.types[static_cast<FileType>(type)] = stats;
+    }
+
+    uint64_t totalFiles = 0;
+    uint64_t fileCount = 0;
+    if (!reader.number(totalFiles) || !reader.info(result.total) || !reader.number(fileCount)) return malformed();
+    result.totalFiles = static_cast<size_t>(totalFiles);
+
+    // every record takes at least its length and counts
+    if (fileCount > reader.remaining() / (4 + INFO_SIZE)) return malformed();
+    result.files.reserve(static_cast<size_t>(fileCount));
+    for (uint64_t i = 0; i < fileCount; ++i) {
+        std::filesystem::path file;
+        FileInfo info;
+        if (!reader.file(file, info)) return malformed();
+        result.files[std::move(file)] = info;
+    }
+
+    uint64_t topCapacity = 0;
+    uint64_t topCount = 0;
+    if (!reader.number(topCapacity) || !reader.number(topCount)
+        || topCount > topCapacity || topCount > reader.remaining() / (4 + INFO_SIZE)) {
+        return malformed();
+    }
+    result.top = TopFiles(static_cast<size_t>(topCapacity));
+    for (uint64_t i = 0; i < topCount; ++i) {
+        std::filesystem::path file;
+        FileInfo info;
+        if (!reader.file(file, info)) return malformed();
+        result.top.add(file, info);
+    }
+
+    if (!reader.number(result.linesPerFile.max) || !reader.counts(result.linesPerFile.counts)
+        || !reader.counts(result.commentRatio.counts)) {
+        return malformed();
+    }
+
+    if (reader.remaining() != 0) return malformed();
+    return result;
+}
+
+std::optional<Shard> Shard::parse(std::string_view text) {
+    Shard shard;
+    auto slash = text.find('/');
+    if (slash == std::string_view::npos) return std::nullopt;
+    auto index = text.substr(0, slash);
+    auto count = text.substr(slash + 1);
+    auto [indexEnd, indexError] = std::from_chars(index.data(), index.data() + index.size(), shard.index);
+    auto [countEnd, countError] = std::from_chars(count.data(), count.data() + count.size(), shard.count);
+    if (indexError != std::errc{} || indexEnd != index.data() + index.size()
+        || countError != std::errc{} || countEnd != count.data() + count.size()
+        || shard.count == 0 || shard.index >= shard.count) {
+        return std::nullopt;
+    }
+    return shard;
+}
+
+bool Shard::contains(std::filesystem::path const& path) const {
+    if (count == 1) return true;
+
+    // FNV-1a over the path as given, with a final mix so that every bit reaches the low ones
+    uint64_t hash = 0xcbf29ce484222325;
+    for (char ch : path.generic_string()) {
+        hash ^= static_cast<unsigned char>(ch);
+        hash *= 0x100000001b3;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccd;
+    hash ^= hash >> 33;
+    return hash % count == index;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+
+#include "Analyzer.hpp"
+#include "FileStatistics.hpp"
+#include "FileType.hpp"
+
+// Everything a scan reports. Results of separate scans, such as the shards of one tree,
+// merge into the result of scanning everything at once.
+struct ScanResult {
+    std::unordered_map<FileType, TypeStats> types;
+    size_t totalFiles = 0;
+    FileInfo total;
+    std::unordered_map<std::filesystem::path, FileInfo> files; // only kept for per-file output
+    TopFiles top;                                              // empty unless given a capacity
+    LineHistogram linesPerFile;
+    RatioHistogram commentRatio;
+
+    void add(std::filesystem::path const& path, FileType type, FileInfo const& info, bool keepFile);
+    // the top files are rebuilt from the per-file records of other if it has any
+    void merge(ScanResult const& other);
+
+    // true if the top count files of this result can be reported, from its top or its per-file records
+    [[nodiscard]] bool hasTop(size_t count) const;
+};
+
+// Binary file holding a ScanResult, per-file records and the top files included if it has any.
+bool writeScanResult(std::filesystem::path const& path, ScanResult const& result);
+std::optional<ScanResult> readScanResult(std::filesystem::path const& path);
+
+// One of count disjoint parts of the file set, chosen by a hash of the path, so that every
+// process given the same paths and the same count agrees on the shard of each file.
+struct Shard {
+    size_t index = 0;
+    size_t count = 1;
+
+    // "<index>/<count>", index counted from 0
+    static std::optional<Shard> parse(std::string_view text);
+
+    [[nodiscard]] bool contains(std::filesystem::path const& path) const;
+};
@@ -1,44 +1,137 @@
 #pragma once
 
+#include <algorithm>
 #include <condition_variable>
+#include <cstdint>
 #include <functional>
 #include <mutex>
 #include <queue>
 #include <thread>
 #include <vector>
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 class ThreadPool {
 public:
-    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency()) { initialize(threads); }
+    // Fifo runs tasks in the order they were enqueued. LargestFirst runs the task with the highest
+    // cost first, so a long task that turns up late does not keep one worker busy after the rest are done.
+    enum class Order {
+        Fifo,
+        LargestFirst,
+    };
+
+    // pinned binds each worker to one of the CPUs the process may run on, in turn (Linux only)
+    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency(), Order order = Order::Fifo, bool pinned = false)
+        : m_order(order), m_pinned(pinned) { initialize(threads); }
     ~ThreadPool() { shutdown(); }
 
-    void enqueue(std::function<void()>&& task) {
+    // cost orders the tasks in LargestFirst order, tasks of equal cost run in FIFO order
+    void enqueue(std::function<void()>&& task, uint64_t cost = 0) {
         {
             std::unique_lock lock(m_queueMutex);
-            m_tasks.push(std::move(task));
+            if (m_order == Order::Fifo) {
+                m_tasks.push(std::move(task));
+            } else {
+                m_heap.push_back({cost, m_nextSequence++, std::move(task)});
+                std::push_heap(m_heap.begin(), m_heap.end(), runsLater);
+            }
         }
         m_condition.notify_one();
     }
 
+    // limits how many workers run tasks at the same time, the others wait until it is raised again
+    void setConcurrency(size_t limit) {
+        {
+            std::unique_lock lock(m_queueMutex);
+            m_limit = std::max<size_t>(limit, 1);
+        }
+        m_condition.notify_all();
+    }
+
+    // blocks until every task enqueued so far has finished
+    void wait() {
+        std::unique_lock lock(m_queueMutex);
+        m_idle.wait(lock, [this] { return empty() && m_running == 0; });
+    }
+
     void initialize(size_t threads) {
+        auto cpus = m_pinned ? availableCpus() : std::vector<int>{};
         for (size_t i = 0; i < threads; ++i) {
+            // a worker releases its finished task and takes the next under one lock, a task takes the queue lock
+            // twice in all, and a slot freed under a concurrency limit goes to the worker that freed it
             m_workers.emplace_back([this] {
+                bool finished = false;
                 while (true) {
                     std::function<void()> task;
                     {
                         std::unique_lock lock(m_queueMutex);
-                        m_condition.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
-                        if (m_stop && m_tasks.empty()) return;
-                        task = std::move(m_tasks.front());
-                        m_tasks.pop();
+                        if (finished && --m_running == 0 && empty()) m_idle.notify_all();
+                        m_condition.wait(lock, [this] { return m_stop || (!empty() && m_running < m_limit); });
+                        if (m_stop && empty()) return;
+                        task = pop();
+                        ++m_running;
                     }
                     task();
+                    finished = true;
                 }
             });
+            if (!cpus.empty()) pin(m_workers.back(), cpus[i % cpus.size()]);
         }
     }
 
 private:
+    struct PrioritizedTask {
+        uint64_t cost;
+        uint64_t sequence;
+        std::function<void()> task;
+    };
+
+    // heap order, the top is the costliest task enqueued first
+    static bool runsLater(PrioritizedTask const& a, PrioritizedTask const& b) {
+        if (a.cost != b.cost) return a.cost < b.cost;
+        return a.sequence > b.sequence;
+    }
+
+    static std::vector<int> availableCpus() {
+        std::vector<int> cpus;
+#ifdef __linux__
+        cpu_set_t set;
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+            }
+        }
+#endif
+        return cpus;
+    }
+
+    static void pin([[maybe_unused]] std::thread& worker, [[maybe_unused]] int cpu) {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(worker.native_handle(), sizeof(set), &set);
+#endif
+    }
+
+    [[nodiscard]] bool empty() const { return m_tasks.empty() && m_heap.empty(); }
+
+    std::function<void()> pop() {
+        std::function<void()> task;
+        if (m_order == Order::Fifo) {
+            task = std::move(m_tasks.front());
+            m_tasks.pop();
+        } else {
+            std::pop_heap(m_heap.begin(), m_heap.end(), runsLater);
+            task = std::move(m_heap.back().task);
+            m_heap.pop_back();
+        }
+        return task;
+    }
+
     void shutdown() {
         {
             std::unique_lock lock(m_queueMutex);
@@ -55,8 +148,15 @@ private:
 
 private:
     std::vector<std::thread> m_workers;
+    Order m_order;
+    bool m_pinned;
+    size_t m_limit = SIZE_MAX;
     std::queue<std::function<void()>> m_tasks;
+    std::vector<PrioritizedTask> m_heap;
+    uint64_t m_nextSequence = 0;
+    size_t m_running = 0;
     std::mutex m_queueMutex;
     std::condition_variable m_condition;
+    std::condition_variable m_idle;
     bool m_stop = false;
 };
\ No newline at end of file
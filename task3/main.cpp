@@ -1,82 +1,324 @@
+#include <array>
+#include <bit>
+#include <charconv>
 #include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
 #include <print>
+#include <semaphore>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include "AdaptiveConcurrency.hpp"
 #include "Analyzer.hpp"
+#include "Archive.hpp"
 #include "ArgParser.hpp"
+#include "BlobCache.hpp"
+#include "CompileCommands.hpp"
+#include "FileType.hpp"
+#include "GitRepository.hpp"
+#include "ScanResult.hpp"
 #include "ThreadPool.hpp"
 #include "Writer.hpp"
 
-enum class FileType {
-    Unknown,
-    Cpp,          // .cpp, .cxx, .cc
-    CppHeader,    // .hpp, .hxx, .hh
-    C,            // .c
-    CHeader,      // .h
-    ObjectiveCpp, // .mm
-};
+static ScanResult scanResult;
+static bool perFileOutput = false;
+static size_t topCount = 0;
+static bool distributionOutput = false;
+static Shard shard;
+static ThreadPool::Order scheduling = ThreadPool::Order::Fifo;
+
+// with separate I/O threads files are read whole by ioPool and classified by the analysis pool
+static ThreadPool* ioPool = nullptr;
+static AdaptiveConcurrency* ioConcurrency = nullptr;
+
+// archive members, git blobs and files read by I/O threads wait in memory for the analysis
+// workers, at most this many at a time
+static constexpr ptrdiff_t MAX_PENDING_BUFFERS = 256;
+static std::counting_semaphore<> pendingBuffers{MAX_PENDING_BUFFERS};
+static BlobCache blobCache;
 
-constexpr std::string_view fileTypeToString(FileType type) {
-    switch (type) {
-        case FileType::Unknown: return "Unknown";
-        case FileType::Cpp: return "C++";
-        case FileType::CppHeader: return "C++ Header";
-        case FileType::C: return "C";
-        case FileType::CHeader: return "C Header";
-        case FileType::ObjectiveCpp: return "Objective-C++";
-        default: return "Invalid Type";
+// Every thread that records files adds them to a result of its own, without a lock, and the
+// results are merged into scanResult once the scan is done.
+static std::mutex threadResultsMutex;
+static std::vector<std::unique_ptr<ScanResult>> threadResults;
+
+ScanResult& threadResult() {
+    thread_local ScanResult* result = nullptr;
+    if (!result) {
+        auto owned = std::make_unique<ScanResult>();
+        owned->top = TopFiles(topCount);
+        std::lock_guard lock(threadResultsMutex);
+        result = threadResults.emplace_back(std::move(owned)).get();
     }
+    return *result;
 }
 
-FileType getFileType(std::filesystem::path const& path) {
-    if (!path.has_extension()) return FileType::Unknown;
-
-    static std::unordered_map<std::string_view, FileType> const extensionMap = {
-        {".cpp", FileType::Cpp},
-        {".cxx", FileType::Cpp},
-        {".cc", FileType::Cpp},
-        {".hpp", FileType::CppHeader},
-        {".hxx", FileType::CppHeader},
-        {".hh", FileType::CppHeader},
-        {".c", FileType::C},
-        {".h", FileType::CHeader},
-        {".mm", FileType::ObjectiveCpp},
-    };
+void recordFile(std::filesystem::path const& path, FileType type, FileInfo const& info) {
+    threadResult().add(path, type, info, perFileOutput);
+}
 
-    auto ext = path.extension().string();
-    auto it = extensionMap.find(ext);
-    if (it != extensionMap.end()) {
-        return it->second;
+// Contents of a file read whole, the buffer is not zeroed before the file is read into it.
+// Buffers are not placed on any particular NUMA node: the I/O threads that fill them are not
+// pinned, and the analysis worker that classifies one may run on another node.
+struct FileContents {
+    std::shared_ptr<char[]> data;
+    size_t size = 0;
+};
+
+// Reads a whole file. firstRead is the time until the first block arrived, which tells a read
+// from the page cache from one that waited on the device whatever the size of the file.
+std::optional<FileContents> readFile(std::filesystem::path const& path, uintmax_t sizeHint,
+                                     std::chrono::nanoseconds& firstRead) {
+    constexpr size_t BLOCK_SIZE = 64 * 1024; // 64 KiB
+    auto start = std::chrono::steady_clock::now();
+
+    std::ifstream file;
+    file.rdbuf()->pubsetbuf(nullptr, 0);
+    file.open(path, std::ios::binary);
+    if (!file) {
+        std::println(std::cerr, "Failed to open file: {}", path.string());
+        return std::nullopt;
     }
 
-    return FileType::Unknown;
+    // one block more than expected, so that a file of the expected size ends with a short read
+    size_t capacity = static_cast<size_t>(sizeHint) + BLOCK_SIZE;
+    FileContents contents{std::make_shared_for_overwrite<char[]>(capacity)};
+    while (true) {
+        if (capacity - contents.size < BLOCK_SIZE) {
+            // the file grew since its size was taken
+            capacity *= 2;
+            auto larger = std::make_shared_for_overwrite<char[]>(capacity);
+            std::copy_n(contents.data.get(), contents.size, larger.get());
+            contents.data = std::move(larger);
+        }
+        file.read(contents.data.get() + contents.size, static_cast<std::streamsize>(capacity - contents.size));
+        auto n = static_cast<size_t>(file.gcount());
+        if (contents.size == 0) firstRead = std::chrono::steady_clock::now() - start;
+        contents.size += n;
+        if (file.eof() || n == 0) break;
+    }
+    return contents;
 }
 
-static std::unordered_map<std::filesystem::path, FileInfo> analyzedFiles;
-static std::unordered_map<FileType, TypeStats> fileInfos;
-static size_t totalFiles = 0;
-static FileInfo totalInfo;
-static std::mutex infoMutex;
-static bool perFileOutput = false;
+void enqueueFile(std::filesystem::path path, FileType type, ThreadPool& threadPool, uintmax_t size = 0) {
+    if (!shard.contains(path)) return;
+    if (ioPool) {
+        ioPool->enqueue([path = std::move(path), type, size, &threadPool]() {
+            std::chrono::nanoseconds latency{};
+            pendingBuffers.acquire();
+            auto contents = readFile(path, size, latency);
+            if (!contents) {
+                pendingBuffers.release();
+                return;
+            }
+            if (ioConcurrency) ioConcurrency->record(latency);
+            threadPool.enqueue([path, type, contents = std::move(*contents)]() {
+                recordFile(path, type, analyze(std::span<char const>(contents.data.get(), contents.size)));
+                pendingBuffers.release();
+            }, size);
+        }, size);
+        return;
+    }
 
-void enqueueFile(std::filesystem::path path, FileType type, ThreadPool& threadPool) {
     threadPool.enqueue([path = std::move(path), type]() {
         auto info = analyze(path);
         if (!info) return;
+        recordFile(path, type, *info);
+    }, size);
+}
+
+// In largest-first order small files go to the pool in batches, unless I/O threads read them: one queue operation
+// per batch instead of per file.
+static constexpr uintmax_t SMALL_FILE_BYTES = 16 * 1024;      // 16 KiB
+static constexpr uintmax_t SMALL_FILE_BATCH_BYTES = 256 * 1024; // 256 KiB
+static std::vector<std::pair<std::filesystem::path, FileType>> smallFiles;
+static uintmax_t smallFilesBytes = 0;
+
+void flushSmallFiles(ThreadPool& threadPool) {
+    if (smallFiles.empty()) return;
+    threadPool.enqueue([files = std::move(smallFiles)]() {
+        auto& result = threadResult();
+        for (auto const& [path, type] : files) {
+            if (auto info = analyze(path)) result.add(path, type, *info, perFileOutput);
+        }
+    }, smallFilesBytes);
+    smallFiles.clear();
+    smallFilesBytes = 0;
+}
+
+void scheduleFile(std::filesystem::path path, FileType type, uintmax_t size, ThreadPool& threadPool) {
+    if (scheduling == ThreadPool::Order::Fifo || ioPool || size >= SMALL_FILE_BYTES) {
+        enqueueFile(std::move(path), type, threadPool, size);
+        return;
+    }
+    if (!shard.contains(path)) return;
+    smallFiles.emplace_back(std::move(path), type);
+    smallFilesBytes += size;
+    if (smallFilesBytes >= SMALL_FILE_BATCH_BYTES) flushSmallFiles(threadPool);
+}
 
-        std::lock_guard lock(infoMutex);
-        if (perFileOutput) {
-            analyzedFiles[path] = *info;
-        } else {
-            fileInfos[type].info += *info;
-            fileInfos[type].fileCount++;
+// Decompresses the archive on the calling thread while the pool classifies the members read so far.
+// Members are reported as <archive>/<member name>.
+void enqueueArchive(std::filesystem::path const& archivePath, ThreadPool& threadPool) {
+    readArchive(
+        archivePath,
+        [&](std::string_view name) {
+            auto path = archivePath / std::filesystem::path(name).relative_path();
+            return getFileType(path) != FileType::Unknown && shard.contains(path);
+        },
+        [&](std::string name, std::vector<char> contents) {
+            pendingBuffers.acquire();
+            auto path = archivePath / std::filesystem::path(name).relative_path();
+            auto type = getFileType(path);
+            auto size = contents.size();
+            threadPool.enqueue([path = std::move(path), type, contents = std::move(contents)]() {
+                recordFile(path, type, analyze(contents));
+                pendingBuffers.release();
+            }, size);
         }
-        totalInfo += *info;
-        ++totalFiles;
+    );
+}
+
+// Reads the tree of a revision from the object database on the calling thread while the pool
+// classifies the blobs read so far. Blobs already in the cache are not read at all.
+// Files are reported as <repository>/<path in the tree>.
+void enqueueRevision(std::filesystem::path const& repoPath, std::string_view revision, ThreadPool& threadPool) {
+    auto repo = GitRepository::open(repoPath);
+    if (!repo) return;
+    auto id = repo->resolve(revision);
+    if (!id) {
+        std::println(std::cerr, "Unknown revision {} in {}", revision, repoPath.string());
+        return;
+    }
+
+    // files with the same contents share a blob, in tree order to read packs mostly forward
+    std::vector<GitObjectId> blobs;
+    std::unordered_map<GitObjectId, std::vector<std::filesystem::path>> blobPaths;
+    bool walked = repo->forEachBlob(*id, [&](std::string const& path, GitObjectId const& blob) {
+        auto filePath = repoPath / path;
+        if (getFileType(filePath) == FileType::Unknown || !shard.contains(filePath)) return;
+        auto [it, inserted] = blobPaths.try_emplace(blob);
+        if (inserted) blobs.push_back(blob);
+        it->second.push_back(std::move(filePath));
     });
+    if (!walked) return;
+
+    for (auto const& blob : blobs) {
+        auto& paths = blobPaths[blob];
+        if (auto info = blobCache.find(blob)) {
+            for (auto const& path : paths) recordFile(path, getFileType(path), *info);
+            continue;
+        }
+
+        auto object = repo->readObject(blob);
+        if (!object) continue;
+        pendingBuffers.acquire();
+        auto size = object->data.size();
+        threadPool.enqueue([blob, paths = std::move(paths), contents = std::move(object->data)]() {
+            auto info = analyze(contents);
+            blobCache.insert(blob, info);
+            for (auto const& path : paths) recordFile(path, getFileType(path), info);
+            pendingBuffers.release();
+        }, size);
+    }
+}
+
+// Reads a list of paths separated by NUL bytes, as find -print0 writes it, from a file or from stdin for "-".
+std::optional<std::vector<std::filesystem::path>> readFileList(std::string_view listPath) {
+    std::string text;
+    if (listPath == "-") {
+        text.assign(std::istreambuf_iterator<char>(std::cin), {});
+    } else {
+        std::ifstream file(std::filesystem::path(listPath), std::ios::binary);
+        if (!file) {
+            std::println(std::cerr, "Failed to open file: {}", listPath);
+            return std::nullopt;
+        }
+        text.assign(std::istreambuf_iterator<char>(file), {});
+    }
+
+    std::vector<std::filesystem::path> paths;
+    size_t begin = 0;
+    while (begin < text.size()) {
+        auto end = text.find('\0', begin);
+        if (end == std::string::npos) end = text.size();
+        if (end > begin) paths.emplace_back(text.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    return paths;
+}
+
+// Files listed explicitly go to the pool as they are, no directory is walked.
+void enqueueFileList(std::vector<std::filesystem::path>& paths, ThreadPool& threadPool) {
+    for (auto& path : paths) {
+        auto fileType = getFileType(path);
+        if (fileType == FileType::Unknown) continue;
+        std::error_code ec;
+        auto size = std::filesystem::file_size(path, ec);
+        if (ec) {
+            std::println(std::cerr, "Error accessing path {}: {}", path.string(), ec.message());
+            continue;
+        }
+        scheduleFile(std::move(path), fileType, size, threadPool);
+    }
+}
+
+// With --with-headers every file of a compilation database is analyzed once, however many
+// translation units include it.
+static bool followIncludes = false;
+static std::mutex visitedMutex;
+static std::unordered_set<std::filesystem::path> visitedFiles;
+
+// Reads a file of a translation unit once for both the analysis and its #include directives.
+// A header is resolved with the include directories of the first translation unit that reaches it.
+void enqueueCompiledFile(std::filesystem::path path, std::shared_ptr<CompileCommand const> command, ThreadPool& threadPool) {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(path, ec);
+    if (ec) {
+        std::println(std::cerr, "Error accessing path {}: {}", path.string(), ec.message());
+        return;
+    }
+
+    threadPool.enqueue([path = std::move(path), command = std::move(command), size, &threadPool]() {
+        std::chrono::nanoseconds latency{};
+        auto contents = readFile(path, size, latency);
+        if (!contents) return;
+        std::span<char const> text(contents->data.get(), contents->size);
+
+        // every shard follows the includes of every file, but counts only its own files
+        auto type = getFileType(path);
+        if (type != FileType::Unknown && shard.contains(path)) recordFile(path, type, analyze(text));
+        if (!followIncludes) return;
+
+        forEachInclude(text, [&](std::string_view name, bool angled) {
+            auto header = command->resolveInclude(name, angled, path);
+            if (!header || getFileType(*header) == FileType::Unknown) return;
+            {
+                std::lock_guard lock(visitedMutex);
+                if (!visitedFiles.insert(*header).second) return;
+            }
+            enqueueCompiledFile(std::move(*header), command, threadPool);
+        });
+    }, size);
+}
+
+void enqueueCompileCommands(std::filesystem::path const& databasePath, ThreadPool& threadPool) {
+    auto commands = readCompileCommands(databasePath);
+    if (!commands) return;
+    for (auto& command : *commands) {
+        auto shared = std::make_shared<CompileCommand const>(std::move(command));
+        {
+            std::lock_guard lock(visitedMutex);
+            if (!visitedFiles.insert(shared->file).second) continue;
+        }
+        auto path = shared->file;
+        enqueueCompiledFile(std::move(path), std::move(shared), threadPool);
+    }
 }
 
 void walkDirectory(std::filesystem::path const& path, ThreadPool& threadPool) {
@@ -86,7 +328,9 @@ void walkDirectory(std::filesystem::path const& path, ThreadPool& threadPool) {
         if (entry.is_regular_file(ec)) {
             auto fileType = getFileType(entry.path());
             if (fileType != FileType::Unknown) {
-                enqueueFile(entry.path(), fileType, threadPool);
+                // sizes only matter for ordering, FIFO order spares the extra stat on some platforms
+                uintmax_t size = scheduling == ThreadPool::Order::Fifo ? 0 : entry.file_size(ec);
+                scheduleFile(entry.path(), fileType, ec ? 0 : size, threadPool);
             }
         } else if (entry.is_directory(ec)) {
             walkDirectory(entry.path(), threadPool);
@@ -94,25 +338,98 @@ void walkDirectory(std::filesystem::path const& path, ThreadPool& threadPool) {
     }
 }
 
+// Histograms by powers of two of lines per file and by tens of percent of comment ratio,
+// and percentiles read from the finer buckets the scan kept.
+void writeDistribution(Writer const& writer, ScanResult const& result) {
+    auto const& lines = result.linesPerFile;
+    std::array<uint64_t, 65> linesByPower{}; // 0, 1, 2-3, 4-7, ...
+    size_t powers = 1;
+    for (size_t i = 0; i < LineHistogram::BUCKETS; ++i) {
+        if (lines.counts[i] == 0) continue;
+        auto power = static_cast<size_t>(std::bit_width(LineHistogram::lowerBound(i)));
+        linesByPower[power] += lines.counts[i];
+        powers = std::max(powers, power + 1);
+    }
+
+    writer.writeln("-------------------------------------------------------------------------------");
+    writer.writeln("Lines per file               files");
+    writer.writeln("-------------------------------------------------------------------------------");
+    for (size_t power = 0; power < powers; ++power) {
+        auto low = power == 0 ? 0 : uint64_t{1} << (power - 1);
+        auto high = power == 0 ? 0 : (uint64_t{1} << (power - 1)) * 2 - 1;
+        auto range = low == high ? std::format("{}", low) : std::format("{}-{}", low, high);
+        writer.writeln("{:<20} {:>13}", range, linesByPower[power]);
+    }
+    writer.writeln("-------------------------------------------------------------------------------");
+    writer.writeln(
+        "Percentiles          p50 {}, p90 {}, p99 {}, max {}",
+        lines.quantile(0.5), lines.quantile(0.9), lines.quantile(0.99), lines.max
+    );
+
+    auto const& ratio = result.commentRatio;
+    std::array<uint64_t, 10> ratioByTens{};
+    for (size_t i = 0; i < RatioHistogram::BUCKETS; ++i) ratioByTens[i / 10] += ratio.counts[i];
+
+    writer.writeln("-------------------------------------------------------------------------------");
+    writer.writeln("Comment ratio                files");
+    writer.writeln("-------------------------------------------------------------------------------");
+    for (size_t tens = 0; tens < ratioByTens.size(); ++tens) {
+        auto range = std::format("{}-{}%", tens * 10, tens == 9 ? 100 : tens * 10 + 9);
+        writer.writeln("{:<20} {:>13}", range, ratioByTens[tens]);
+    }
+    writer.writeln("-------------------------------------------------------------------------------");
+    writer.writeln(
+        "Percentiles          p50 {}%, p90 {}%, p99 {}%",
+        ratio.quantile(0.5), ratio.quantile(0.9), ratio.quantile(0.99)
+    );
+    writer.writeln("-------------------------------------------------------------------------------");
+}
+
 int main(int argc, char** argv) {
     if (argc < 2) {
-        std::println("Usage: {} [-h | --help] [-f | --per-file] [-o | --output=<filename>] <path>...", argv[0]);
+        std::println("Usage: {} [-h | --help] [-f | --per-file] [-o | --output=<filename>] [--git-rev=<revision> [--blob-cache=<filename>]]", argv[0]);
+        std::println("       [--jobs=<count>] [--io-jobs=<count>|auto] [--pin] [--schedule=fifo|largest-first]");
+        std::println("       [--shard=<index>/<count>] [--partial=<filename>]");
+        std::println("       [--files-from=<filename>|-] [--compile-commands=<filename> [--with-headers]] <path>...");
+        std::println("       [--top=<count>] [--distribution]");
+        std::println("       {} --merge [-f | --per-file] [-o | --output=<filename>] [--top=<count>] [--distribution] <partial>...", argv[0]);
         return 1;
     }
 
     ArgParser parser{argc, argv};
     if (parser.hasFlag("--help") || parser.hasFlag("-h")) {
-        std::println("Usage: {} [-h | --help] [-f | --per-file] [-o | --output=<filename>] <path>...", argv[0]);
+        std::println("Usage: {} [-h | --help] [-f | --per-file] [-o | --output=<filename>] [--git-rev=<revision> [--blob-cache=<filename>]]", argv[0]);
+        std::println("       [--jobs=<count>] [--io-jobs=<count>|auto] [--pin] [--schedule=fifo|largest-first]");
+        std::println("       [--shard=<index>/<count>] [--partial=<filename>]");
+        std::println("       [--files-from=<filename>|-] [--compile-commands=<filename> [--with-headers]] <path>...");
+        std::println("       [--top=<count>] [--distribution]");
+        std::println("       {} --merge [-f | --per-file] [-o | --output=<filename>] [--top=<count>] [--distribution] <partial>...", argv[0]);
         std::println("Options:");
         std::println("  --help -h        Show this help message");
         std::println("  --per-file -f    Output analysis results per file");
         std::println("  --output -o      Specify output file (default: stdout)");
+        std::println("  --top            Also output the given number of files with the most lines");
+        std::println("  --distribution   Also output histograms and percentiles of lines per file and comment ratio");
+        std::println("  --git-rev        Analyze this revision of the git repositories given as paths, not their working trees");
+        std::println("  --blob-cache     File that keeps the results per git blob between runs");
+        std::println("  --jobs           Number of analysis threads (default: one per CPU)");
+        std::println("  --io-jobs        Read files on this many separate threads, auto adjusts the count to the read latency");
+        std::println("  --pin            Bind each analysis thread to its own CPU (Linux only)");
+        std::println("  --schedule       Order of analysis: fifo as files are found (default), or largest-first");
+        std::println("  --shard          Analyze only the files of this shard, from 0 to count - 1, chosen by path");
+        std::println("  --partial        Also save the results to a partial result file, with -f including every file");
+        std::println("  --files-from     Also analyze the files listed in this file, or stdin for -, separated by NUL bytes");
+        std::println("  --compile-commands Also analyze the sources of this compile_commands.json, or of the one in this directory");
+        std::println("  --with-headers   With --compile-commands, also analyze the headers the sources include");
+        std::println("  --merge          Report the combined results of the partial result files given as paths");
+        std::println("A path is a directory, a source file or a .tar, .tar.gz or .tar.zst archive.");
         return 0;
     }
 
     if (parser.hasFlag("--per-file") || parser.hasFlag("-f")) {
         perFileOutput = true;
     }
+    distributionOutput = parser.hasFlag("--distribution");
 
     Writer writer{};
     std::ofstream out;
@@ -130,10 +447,102 @@ int main(int argc, char** argv) {
         }
     }
 
+    auto gitRevision = parser.getOptionValue("--git-rev");
+    auto blobCachePath = parser.getOptionValue("--blob-cache");
+    if (!blobCachePath.empty() && !blobCache.attach(std::filesystem::path(blobCachePath))) {
+        return 1;
+    }
+
+    auto shardOption = parser.getOptionValue("--shard");
+    if (!shardOption.empty()) {
+        auto parsed = Shard::parse(shardOption);
+        if (!parsed) {
+            std::println(std::cerr, "Invalid shard {}, expected <index>/<count> with index < count", shardOption);
+            return 1;
+        }
+        shard = *parsed;
+    }
+
+    auto schedule = parser.getOptionValue("--schedule");
+    if (schedule == "largest-first") {
+        scheduling = ThreadPool::Order::LargestFirst;
+    } else if (!schedule.empty() && schedule != "fifo") {
+        std::println(std::cerr, "Invalid schedule {}, expected fifo or largest-first", schedule);
+        return 1;
+    }
+
+    auto const parseCount = [](std::string_view text, size_t& count) {
+        auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), count);
+        return ec == std::errc{} && end == text.data() + text.size() && count > 0;
+    };
+
+    auto topOption = parser.getOptionValue("--top");
+    if (!topOption.empty() && !parseCount(topOption, topCount)) {
+        std::println(std::cerr, "Invalid number of top files: {}", topOption);
+        return 1;
+    }
+    scanResult.top = TopFiles(topCount);
+
+    size_t jobs = std::max(1u, std::thread::hardware_concurrency());
+    auto jobsOption = parser.getOptionValue("--jobs");
+    if (!jobsOption.empty() && !parseCount(jobsOption, jobs)) {
+        std::println(std::cerr, "Invalid number of jobs: {}", jobsOption);
+        return 1;
+    }
+
+    // adaptive I/O starts at one reader per CPU and moves between 1 and 64
+    constexpr size_t MAX_IO_JOBS = 64;
+    size_t ioJobs = 0;
+    auto ioJobsOption = parser.getOptionValue("--io-jobs");
+    bool adaptiveIo = ioJobsOption == "auto";
+    if (adaptiveIo) {
+        ioJobs = MAX_IO_JOBS;
+    } else if (!ioJobsOption.empty() && !parseCount(ioJobsOption, ioJobs)) {
+        std::println(std::cerr, "Invalid number of I/O jobs: {}", ioJobsOption);
+        return 1;
+    }
+
+    auto fileListPath = parser.getOptionValue("--files-from");
+    auto compileCommandsPath = parser.getOptionValue("--compile-commands");
+    followIncludes = parser.hasFlag("--with-headers");
+
+    bool pinned = parser.hasFlag("--pin");
+#ifndef __linux__
+    if (pinned) std::println(std::cerr, "--pin is only supported on Linux, threads are not pinned");
+#endif
+
     std::chrono::time_point<std::chrono::system_clock> start, end;
-    {
-        ThreadPool threadPool;
+    if (parser.hasFlag("--merge")) {
         start = std::chrono::high_resolution_clock::now();
+        for (auto varg : parser.positionalArgs()) {
+            auto partial = readScanResult(std::filesystem::path(varg));
+            if (!partial) return 1;
+            if (!partial->hasTop(topCount)) {
+                std::println(std::cerr, "Partial result {} keeps fewer than the top {} files, write it with --top={} or -f", varg, topCount, topCount);
+                return 1;
+            }
+            scanResult.merge(*partial);
+        }
+        end = std::chrono::high_resolution_clock::now();
+    } else {
+        ThreadPool threadPool{jobs, scheduling, pinned};
+        std::optional<ThreadPool> readers;
+        std::optional<AdaptiveConcurrency> readerConcurrency;
+        if (ioJobs > 0) {
+            ioPool = &readers.emplace(ioJobs, scheduling);
+            if (adaptiveIo) {
+                ioConcurrency = &readerConcurrency.emplace(*ioPool, 1, MAX_IO_JOBS, std::max(1u, std::thread::hardware_concurrency()));
+            }
+        }
+        start = std::chrono::high_resolution_clock::now();
+        if (!fileListPath.empty()) {
+            auto paths = readFileList(fileListPath);
+            if (!paths) return 1;
+            enqueueFileList(*paths, threadPool);
+        }
+        if (!compileCommandsPath.empty()) {
+            enqueueCompileCommands(std::filesystem::path(compileCommandsPath), threadPool);
+        }
         for (auto varg : parser.positionalArgs()) {
             std::filesystem::path path(varg);
             std::error_code ec;
@@ -148,36 +557,55 @@ int main(int argc, char** argv) {
             CHECK_ERR_CODE;
 
             if (std::filesystem::is_directory(path, ec)) {
-                walkDirectory(path, threadPool);
+                if (!gitRevision.empty()) {
+                    enqueueRevision(path, gitRevision, threadPool);
+                } else {
+                    walkDirectory(path, threadPool);
+                }
             }
             CHECK_ERR_CODE;
 
             if (std::filesystem::is_regular_file(path, ec)) {
                 auto fileType = getFileType(path);
-                if (fileType != FileType::Unknown) {
-                    enqueueFile(path, fileType, threadPool);
+                if (isArchive(path)) {
+                    enqueueArchive(path, threadPool);
+                } else if (fileType != FileType::Unknown) {
+                    auto size = std::filesystem::file_size(path, ec);
+                    enqueueFile(path, fileType, threadPool, ec ? 0 : size);
                 }
             }
             CHECK_ERR_CODE;
         }
+        flushSmallFiles(threadPool);
+        if (ioPool) ioPool->wait(); // reads enqueue the analysis of what they read
+        threadPool.wait();
+        for (auto const& result : threadResults) scanResult.merge(*result);
         end = std::chrono::high_resolution_clock::now();
+        ioConcurrency = nullptr;
+        ioPool = nullptr;
+    }
+    blobCache.save();
+
+    auto partialPath = parser.getOptionValue("--partial");
+    if (!partialPath.empty() && !writeScanResult(std::filesystem::path(partialPath), scanResult)) {
+        return 1;
     }
 
     auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
     writer.writeln(
         "Analysis completed in {} ns ({} files/s, {} lines/s)",
-        duration, (totalFiles * 1'000'000'000LL) / duration,
-        ((totalInfo.blankLines + totalInfo.commentLines + totalInfo.codeLines) * 1'000'000'000LL) / duration
+        duration, (scanResult.totalFiles * 1'000'000'000LL) / duration,
+        ((scanResult.total.blankLines + scanResult.total.commentLines + scanResult.total.codeLines) * 1'000'000'000LL) / duration
     );
 
     if (perFileOutput) {
-        writer.writeln("Total files analyzed: {}", totalFiles);
+        writer.writeln("Total files analyzed: {}", scanResult.totalFiles);
         writer.writeln("--------------------------------------------------------------------------------------------------------------------------------------------");
         writer.writeln("{:<95} {:>14} {:>14} {:>14}", "file", "blank", "comment", "code");
         writer.writeln("--------------------------------------------------------------------------------------------------------------------------------------------");
 
         // sort the files by total lines descending
-        std::vector<std::pair<std::filesystem::path, FileInfo>> sortedFiles(analyzedFiles.begin(), analyzedFiles.end());
+        std::vector<std::pair<std::filesystem::path, FileInfo>> sortedFiles(scanResult.files.begin(), scanResult.files.end());
         std::sort(sortedFiles.begin(), sortedFiles.end(), [](auto const& a, auto const& b) {
             return a.second.totalLines() > b.second.totalLines();
         });
@@ -189,7 +617,7 @@ int main(int argc, char** argv) {
 
         // print summary
         writer.writeln("--------------------------------------------------------------------------------------------------------------------------------------------");
-        writer.writeln("{:<95} {:>14} {:>14} {:>14}", "Total", totalInfo.blankLines, totalInfo.commentLines, totalInfo.codeLines);
+        writer.writeln("{:<95} {:>14} {:>14} {:>14}", "Total", scanResult.total.blankLines, scanResult.total.commentLines, scanResult.total.codeLines);
         writer.writeln("--------------------------------------------------------------------------------------------------------------------------------------------");
     } else {
         writer.writeln("-------------------------------------------------------------------------------");
@@ -197,7 +625,7 @@ int main(int argc, char** argv) {
         writer.writeln("-------------------------------------------------------------------------------");
 
         // sort by total lines descending
-        std::vector<std::pair<FileType, TypeStats>> sortedFileInfos(fileInfos.begin(), fileInfos.end());
+        std::vector<std::pair<FileType, TypeStats>> sortedFileInfos(scanResult.types.begin(), scanResult.types.end());
         std::sort(sortedFileInfos.begin(), sortedFileInfos.end(), [](auto const& a, auto const& b) {
             return a.second.info.totalLines() > b.second.info.totalLines();
         });
@@ -214,13 +642,28 @@ int main(int argc, char** argv) {
         writer.writeln("-------------------------------------------------------------------------------");
         writer.writeln(
             "Total                {:>13} {:>14} {:>14} {:>14}",
-            totalFiles,
-            totalInfo.blankLines,
-            totalInfo.commentLines,
-            totalInfo.codeLines
+            scanResult.totalFiles,
+            scanResult.total.blankLines,
+            scanResult.total.commentLines,
+            scanResult.total.codeLines
         );
         writer.writeln("-------------------------------------------------------------------------------");
     }
 
+    if (topCount > 0) {
+        writer.writeln("Largest files:");
+        writer.writeln("--------------------------------------------------------------------------------------------------------------------------------------------");
+        writer.writeln("{:<95} {:>14} {:>14} {:>14}", "file", "blank", "comment", "code");
+        writer.writeln("--------------------------------------------------------------------------------------------------------------------------------------------");
+        for (auto const& [path, info] : scanResult.top.sorted()) {
+            writer.writeln("{:<95} {:>14} {:>14} {:>14}", path.string(), info.blankLines, info.commentLines, info.codeLines);
+        }
+        writer.writeln("--------------------------------------------------------------------------------------------------------------------------------------------");
+    }
+
+    if (distributionOutput) {
+        writeDistribution(writer, scanResult);
+    }
+
     return 0;
 }
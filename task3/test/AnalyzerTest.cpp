@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <random>
+#include <string>
+#include <string_view>
+#include <gtest/gtest.h>
+#include "Analyzer.hpp"
+
+namespace {
+    FileInfo analyzeText(std::string_view text) {
+        return analyze(std::span<char const>(text.data(), text.size()));
+    }
+
+    void expectInfo(FileInfo const& info, size_t blank, size_t comment, size_t code) {
+        EXPECT_EQ(info.blankLines, blank);
+        EXPECT_EQ(info.commentLines, comment);
+        EXPECT_EQ(info.codeLines, code);
+    }
+}
+
+// Test the classification of whole texts
+TEST(AnalyzerTest, ClassifiesLines) {
+    expectInfo(analyzeText(""), 0, 0, 0);
+    expectInfo(analyzeText("int x;\n\n// comment\n"), 1, 1, 1);
+    expectInfo(analyzeText("int x; // trailing\n"), 0, 0, 1);
+    expectInfo(analyzeText("/* a\n\n   b */ int y;\n"), 1, 1, 1);
+    expectInfo(analyzeText("char const* s = \"/* not a comment\";\n"), 0, 0, 1);
+    expectInfo(analyzeText("char c = '\"'; // \"\n"), 0, 0, 1);
+    expectInfo(analyzeText("#define A \\\n    1\n"), 0, 0, 2);
+    expectInfo(analyzeText("  \t\r\n"), 1, 0, 0);
+    expectInfo(analyzeText("last line without a break"), 0, 0, 1);
+}
+
+// Test that the text ends at the first NUL character
+TEST(AnalyzerTest, StopsAtNul) {
+    std::string text = "int x;\n// c\n";
+    text += '\0';
+    text += "more code\n";
+    expectInfo(analyzeText(text), 0, 1, 1);
+
+    IncrementalAnalyzer analyzer;
+    analyzer.feed({text.data(), 8});
+    analyzer.feed({text.data() + 8, text.size() - 8});
+    analyzer.feed({"int y;\n", 7});
+    expectInfo(analyzer.finish(), 0, 1, 1);
+}
+
+// Test that a copied analyzer carries on from the state at the copy
+TEST(AnalyzerTest, CopySavesState) {
+    IncrementalAnalyzer analyzer;
+    analyzer.feed({"int x; /", 8});
+    auto copy = analyzer;
+    analyzer.feed({"* c */\n", 7});
+    copy.feed({"/ c\n", 4});
+    expectInfo(analyzer.finish(), 0, 0, 1);
+    expectInfo(copy.finish(), 0, 0, 1);
+
+    IncrementalAnalyzer comment;
+    comment.feed({"/", 1});
+    auto lineComment = comment;
+    lineComment.feed({"/ only a comment\n", 17});
+    expectInfo(lineComment.finish(), 0, 1, 0);
+    comment.feed({" 2\n", 3});
+    expectInfo(comment.finish(), 0, 0, 1);
+}
+
+// Test that random texts split at random points classify like the whole text, with chunk
+// boundaries inside comment delimiters, escapes and line continuations
+TEST(AnalyzerTest, RandomChunksMatchWholeText) {
+    std::mt19937 random(42);
+    std::string_view const alphabet = "/*\\\"'\n a\t\r";
+    for (int i = 0; i < 5000; ++i) {
+        std::string text;
+        size_t length = random() % 60;
+        for (size_t j = 0; j < length; ++j) text += alphabet[random() % alphabet.size()];
+        if (random() % 10 == 0) {
+            text += '\0';
+            text += "x\n";
+        }
+
+        auto whole = analyzeText(text);
+        for (int round = 0; round < 8; ++round) {
+            std::uniform_int_distribution<size_t> chunkSize(0, round < 4 ? 3 : 100);
+            IncrementalAnalyzer analyzer;
+            for (size_t pos = 0; pos < text.size();) {
+                auto size = std::min(chunkSize(random), text.size() - pos);
+                analyzer.feed({text.data() + pos, size});
+                pos += size;
+            }
+            auto chunked = analyzer.finish();
+            ASSERT_EQ(chunked.blankLines, whole.blankLines) << testing::PrintToString(text);
+            ASSERT_EQ(chunked.commentLines, whole.commentLines) << testing::PrintToString(text);
+            ASSERT_EQ(chunked.codeLines, whole.codeLines) << testing::PrintToString(text);
+        }
+    }
+}
@@ -0,0 +1,228 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include "Archive.hpp"
+#include "TempDir.hpp"
+
+#ifdef TASK3_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+    constexpr size_t BLOCK_SIZE = 512;
+
+    // offsets of the ustar header fields
+    constexpr size_t NAME = 0;
+    constexpr size_t MODE = 100;
+    constexpr size_t SIZE = 124;
+    constexpr size_t CHECKSUM = 148;
+    constexpr size_t TYPEFLAG = 156;
+    constexpr size_t MAGIC = 257;
+    constexpr size_t PREFIX = 345;
+
+    struct Header {
+        std::string name{};
+        uint64_t size = 0;
+        char typeflag = '0';
+        std::string prefix{};
+        bool gnu = false;     // "ustar  " magic, whose writers keep other fields in place of the prefix
+        bool base256 = false; // size in GNU base-256
+    };
+
+    // sets the checksum of a header block edited by hand
+    std::string sealed(std::string block) {
+        std::memset(block.data() + CHECKSUM, ' ', 8);
+        unsigned sum = 0;
+        for (char ch : block) sum += static_cast<unsigned char>(ch);
+        std::snprintf(block.data() + CHECKSUM, 8, "%06o", sum);
+        return block;
+    }
+
+    std::string headerBlock(Header const& header) {
+        std::string block(BLOCK_SIZE, '\0');
+        header.name.copy(block.data() + NAME, 100);
+        std::memcpy(block.data() + MODE, "0000644", 7);
+        if (header.base256) {
+            block[SIZE] = static_cast<char>(0x80);
+            for (size_t i = 0; i < 8; ++i) block[SIZE + 11 - i] = static_cast<char>(header.size >> (8 * i));
+        } else {
+            std::snprintf(block.data() + SIZE, 12, "%011llo", static_cast<unsigned long long>(header.size));
+        }
+        block[TYPEFLAG] = header.typeflag;
+        std::memcpy(block.data() + MAGIC, header.gnu ? "ustar  " : "ustar\0" "00", 8);
+        header.prefix.copy(block.data() + PREFIX, 155);
+        return sealed(std::move(block));
+    }
+
+    std::string padded(std::string contents) {
+        contents.resize((contents.size() + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE, '\0');
+        return contents;
+    }
+
+    std::string member(Header header, std::string const& contents) {
+        header.size = contents.size();
+        return headerBlock(header) + padded(contents);
+    }
+
+    std::string endOfArchive() {
+        return std::string(2 * BLOCK_SIZE, '\0');
+    }
+
+    struct ReadResult {
+        bool ok = false;
+        std::vector<std::pair<std::string, std::string>> members;
+    };
+
+    ReadResult read(std::filesystem::path const& path, std::function<bool(std::string_view)> const& wanted = [](std::string_view) { return true; }) {
+        ReadResult result;
+        result.ok = readArchive(path, wanted, [&](std::string name, std::vector<char> contents) {
+            result.members.emplace_back(std::move(name), std::string(contents.begin(), contents.end()));
+        });
+        return result;
+    }
+
+    using Members = std::vector<std::pair<std::string, std::string>>;
+}
+
+// Test which paths are taken for archives
+TEST(ArchiveTest, IsArchive) {
+    EXPECT_TRUE(isArchive("src.tar"));
+    EXPECT_TRUE(isArchive("dir/src.tar.gz"));
+    EXPECT_TRUE(isArchive("src.tgz"));
+    EXPECT_TRUE(isArchive("src.tar.zst"));
+    EXPECT_FALSE(isArchive("src.gz"));
+    EXPECT_FALSE(isArchive("tar.cpp"));
+}
+
+// Test reading regular members and skipping the others
+TEST(ArchiveTest, ReadsMembers) {
+    TempDir dir;
+    std::string archive = headerBlock({.name = "src/", .typeflag = '5'})
+        + member({.name = "src/a.cpp"}, "int a;\n")
+        + member({.name = "src/skip.txt"}, std::string(700, 'x'))
+        + member({.name = "src/b.h", .typeflag = '\0'}, std::string(BLOCK_SIZE, 'b'))
+        + headerBlock({.name = "src/link.cpp", .typeflag = '2'})
+        + member({.name = "src/empty.c"}, "")
+        + endOfArchive();
+    auto path = dir.write("a.tar", archive);
+
+    auto result = read(path, [](std::string_view name) { return !name.ends_with(".txt"); });
+    EXPECT_TRUE(result.ok);
+    Members expected = {{"src/a.cpp", "int a;\n"}, {"src/b.h", std::string(BLOCK_SIZE, 'b')}, {"src/empty.c", ""}};
+    EXPECT_EQ(result.members, expected);
+
+    // archives without the end-of-archive blocks are accepted
+    dir.write("short.tar", member({.name = "a.c"}, "x"));
+    result = read(dir.path() / "short.tar");
+    EXPECT_TRUE(result.ok);
+    EXPECT_EQ(result.members.size(), 1u);
+}
+
+// Test the places long names are kept in
+TEST(ArchiveTest, MemberNames) {
+    TempDir dir;
+    std::string longName = std::string(120, 'd') + "/file.cpp";
+    std::string archive = member({.name = "name.cpp", .prefix = "ustar/prefix"}, "1")
+        + member({.name = "gnu.cpp", .prefix = "ignored", .gnu = true}, "2")
+        + member({.name = "././@LongLink", .typeflag = 'L', .gnu = true}, longName + '\0')
+        + member({.name = "truncated", .gnu = true}, "3")
+        + member({.name = "PaxHeaders/x", .typeflag = 'x'}, "30 mtime=1700000000.123456789\n" "21 path=pax/name.cpp\n")
+        + member({.name = "short"}, "4")
+        + member({.name = "after.cpp"}, "5")
+        + endOfArchive();
+    auto path = dir.write("names.tar", archive);
+
+    auto result = read(path);
+    EXPECT_TRUE(result.ok);
+    Members expected = {
+        {"ustar/prefix/name.cpp", "1"}, {"gnu.cpp", "2"}, {longName, "3"}, {"pax/name.cpp", "4"}, {"after.cpp", "5"},
+    };
+    EXPECT_EQ(result.members, expected);
+}
+
+// Test the encodings of the member size
+TEST(ArchiveTest, SizeFields) {
+    TempDir dir;
+    std::string contents(1000, 'z');
+
+    auto base256 = headerBlock({.name = "big.cpp", .size = contents.size(), .base256 = true}) + padded(contents) + endOfArchive();
+    auto result = read(dir.write("base256.tar", base256));
+    EXPECT_TRUE(result.ok);
+    ASSERT_EQ(result.members.size(), 1u);
+    EXPECT_EQ(result.members[0].second, contents);
+
+    // octal with leading spaces and a trailing space instead of the NUL
+    auto spaced = headerBlock({.name = "spaced.cpp", .size = 3});
+    std::memcpy(spaced.data() + SIZE, "        03 ", 12);
+    result = read(dir.write("spaced.tar", sealed(spaced) + padded("abc") + endOfArchive()));
+    EXPECT_TRUE(result.ok);
+    ASSERT_EQ(result.members.size(), 1u);
+    EXPECT_EQ(result.members[0].second, "abc");
+}
+
+// Test that malformed archives fail, keeping the members read before
+TEST(ArchiveTest, MalformedArchives) {
+    TempDir dir;
+    auto first = member({.name = "ok.cpp"}, "ok");
+
+    auto badChecksum = headerBlock({.name = "bad.cpp", .size = 1});
+    badChecksum[NAME] = 'c';
+    auto result = read(dir.write("checksum.tar", first + badChecksum + padded("x") + endOfArchive()));
+    EXPECT_FALSE(result.ok);
+    EXPECT_EQ(result.members.size(), 1u);
+
+    // contents cut short, and sizes far beyond the end of the file, which are not allocated up front
+    result = read(dir.write("cut.tar", first + headerBlock({.name = "cut.cpp", .size = 2000}) + std::string(600, 'c')));
+    EXPECT_FALSE(result.ok);
+    EXPECT_EQ(result.members.size(), 1u);
+    for (uint64_t size : {uint64_t{1} << 40, ~uint64_t{0} >> 2}) {
+        result = read(dir.write("huge.tar", first + headerBlock({.name = "huge.cpp", .size = size, .base256 = true}) + endOfArchive()));
+        EXPECT_FALSE(result.ok) << size;
+        EXPECT_EQ(result.members.size(), 1u);
+    }
+
+    // negative base-256, and digits that are not octal
+    auto negative = headerBlock({.name = "neg.cpp", .size = 1, .base256 = true});
+    negative[SIZE] = static_cast<char>(0xff);
+    EXPECT_FALSE(read(dir.write("negative.tar", sealed(negative) + padded("x") + endOfArchive())).ok);
+
+    auto notOctal = headerBlock({.name = "nine.cpp", .size = 1});
+    notOctal[SIZE + 10] = '9';
+    EXPECT_FALSE(read(dir.write("octal.tar", sealed(notOctal) + padded("x") + endOfArchive())).ok);
+
+    // an oversized long name
+    EXPECT_FALSE(read(dir.write("longname.tar",
+        member({.name = "././@LongLink", .typeflag = 'L', .gnu = true}, std::string((1 << 20) + 1, 'n')) + endOfArchive())).ok);
+
+    // a header cut short
+    EXPECT_FALSE(read(dir.write("header.tar", first + std::string(100, 'h'))).ok);
+    EXPECT_FALSE(read(dir.path() / "missing.tar").ok);
+}
+
+#ifdef TASK3_HAVE_ZLIB
+// Test reading an archive compressed with gzip
+TEST(ArchiveTest, Gzip) {
+    TempDir dir;
+    std::string archive = member({.name = "a.cpp"}, "int a;\n") + member({.name = "b.cpp"}, std::string(100000, 'b')) + endOfArchive();
+    auto path = dir.path() / "a.tar.gz";
+    auto file = gzopen(path.string().c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    gzwrite(file, archive.data(), static_cast<unsigned>(archive.size()));
+    gzclose(file);
+
+    auto result = read(path);
+    EXPECT_TRUE(result.ok);
+    Members expected = {{"a.cpp", "int a;\n"}, {"b.cpp", std::string(100000, 'b')}};
+    EXPECT_EQ(result.members, expected);
+
+    // a stream cut short
+    auto compressed = std::filesystem::file_size(path);
+    std::filesystem::resize_file(path, compressed / 2);
+    EXPECT_FALSE(read(path).ok);
+}
+#endif
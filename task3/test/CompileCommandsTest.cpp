@@ -0,0 +1,153 @@
+#include <string>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include "CompileCommands.hpp"
+#include "TempDir.hpp"
+
+namespace {
+    std::vector<std::filesystem::path> paths(std::initializer_list<char const*> names) {
+        return {names.begin(), names.end()};
+    }
+
+    std::vector<std::pair<std::string, bool>> includes(std::string_view text) {
+        std::vector<std::pair<std::string, bool>> found;
+        forEachInclude(std::span<char const>(text.data(), text.size()), [&](std::string_view name, bool angled) {
+            found.emplace_back(name, angled);
+        });
+        return found;
+    }
+}
+
+// Test reading entries with "arguments" and with a "command" split like a shell would
+TEST(CompileCommandsTest, ReadsEntries) {
+    TempDir dir;
+    dir.write("build/compile_commands.json", R"([
+        {
+            "directory": "/work/build",
+            "arguments": ["g++", "-I", "../include", "-iquote", "quoted", "-isystem/sys", "-c", "../src/a.cpp"],
+            "file": "../src/a.cpp",
+            "output": "a.o"
+        },
+        {
+            "file": "/work/src/b.cpp",
+            "directory": "/work",
+            "command": "clang++ -I'dir with spaces' \"-Iescaped \\\"quote\\\"\" -Iback\\ slash --include-directory=inc -idirafter after -c src/b.cpp",
+            "extra": {"nested": [1, 2.5e3, true, null, "x"]}
+        },
+        {"directory": "/work", "file": "src/a.cpp", "command": "g++ -Iignored src/a.cpp"}
+    ])");
+
+    auto commands = readCompileCommands(dir.path() / "build");
+    ASSERT_TRUE(commands);
+    ASSERT_EQ(commands->size(), 2u);
+
+    auto const& a = (*commands)[0];
+    EXPECT_EQ(a.file, "/work/src/a.cpp");
+    EXPECT_EQ(a.includeDirs, paths({"/work/include", "/sys"}));
+    EXPECT_EQ(a.quoteDirs, paths({"/work/build/quoted"}));
+
+    auto const& b = (*commands)[1];
+    EXPECT_EQ(b.file, "/work/src/b.cpp");
+    EXPECT_EQ(b.includeDirs, paths({"/work/dir with spaces", "/work/escaped \"quote\"", "/work/back slash", "/work/inc", "/work/after"}));
+    EXPECT_TRUE(b.quoteDirs.empty());
+}
+
+// Test that /I only names a directory for cl-style drivers
+TEST(CompileCommandsTest, ClIncludeFlag) {
+    TempDir dir;
+    auto path = dir.write("compile_commands.json", R"([
+        {"directory": "/work", "file": "a.c", "arguments": ["gcc", "-c", "/Include/a.c"]},
+        {"directory": "/work", "file": "b.c", "arguments": ["C:\\VS\\bin\\CL.EXE", "/Iinc", "/I", "other", "b.c"]},
+        {"directory": "/work", "file": "c.c", "arguments": ["/usr/bin/clang-cl", "/Iinc", "c.c"]}
+    ])");
+
+    auto commands = readCompileCommands(path);
+    ASSERT_TRUE(commands);
+    ASSERT_EQ(commands->size(), 3u);
+    EXPECT_TRUE((*commands)[0].includeDirs.empty());
+    EXPECT_EQ((*commands)[1].includeDirs, paths({"/work/inc", "/work/other"}));
+    EXPECT_EQ((*commands)[2].includeDirs, paths({"/work/inc"}));
+}
+
+// Test the string escapes of the JSON reader
+TEST(CompileCommandsTest, JsonStrings) {
+    TempDir dir;
+    auto path = dir.write("compile_commands.json",
+        R"([{"directory": "/w", "file": "caf\u00e9\/\ud83d\ude00.cpp", "arguments": ["cc", "-I\u0041\t"]}])");
+
+    auto commands = readCompileCommands(path);
+    ASSERT_TRUE(commands);
+    ASSERT_EQ(commands->size(), 1u);
+    EXPECT_EQ((*commands)[0].file, "/w/caf\xc3\xa9/\xf0\x9f\x98\x80.cpp");
+    EXPECT_EQ((*commands)[0].includeDirs, paths({"/w/A\t"}));
+
+    EXPECT_TRUE(readCompileCommands(dir.write("empty.json", " [ ] ")));
+}
+
+// Test that malformed databases are rejected
+TEST(CompileCommandsTest, MalformedDatabases) {
+    TempDir dir;
+    for (std::string_view text : {
+             "",
+             "{}",
+             "[",
+             R"([{"directory": "/w", "file": "a.c"},])",
+             R"([{"directory": "/w", "file": "a.c"}] trailing)",
+             R"([{"directory": "/w"}])",
+             R"([{"directory": "/w", "file": "a.c", "arguments": "not an array"}])",
+             R"([{"directory": "/w", "file": "\ud83d\u0041"}])",
+             R"([{"directory": "/w", "file": "unterminated}])",
+         }) {
+        EXPECT_FALSE(readCompileCommands(dir.write("compile_commands.json", text))) << text;
+    }
+    EXPECT_FALSE(readCompileCommands(dir.path() / "missing"));
+}
+
+// Test the lookup order of quoted and angled includes
+TEST(CompileCommandsTest, ResolveInclude) {
+    TempDir dir;
+    auto includer = dir.write("src/a.cpp", "");
+    dir.write("src/local.h", "");
+    dir.write("quote/local.h", "");
+    dir.write("quote/quoted.h", "");
+    dir.write("inc/local.h", "");
+    dir.write("inc/quoted.h", "");
+    dir.write("inc/sub/angled.h", "");
+
+    CompileCommand command;
+    command.file = includer;
+    command.quoteDirs = {dir.path() / "quote"};
+    command.includeDirs = {dir.path() / "missing", dir.path() / "inc"};
+
+    EXPECT_EQ(command.resolveInclude("local.h", false, includer), dir.path() / "src/local.h");
+    EXPECT_EQ(command.resolveInclude("local.h", true, includer), dir.path() / "inc/local.h");
+    EXPECT_EQ(command.resolveInclude("quoted.h", false, includer), dir.path() / "quote/quoted.h");
+    EXPECT_EQ(command.resolveInclude("quoted.h", true, includer), dir.path() / "inc/quoted.h");
+    EXPECT_EQ(command.resolveInclude("sub/angled.h", true, includer), dir.path() / "inc/sub/angled.h");
+    EXPECT_EQ(command.resolveInclude("../src/local.h", false, includer), dir.path() / "src/local.h");
+    EXPECT_EQ(command.resolveInclude((dir.path() / "inc/quoted.h").string(), true, includer), dir.path() / "inc/quoted.h");
+    EXPECT_FALSE(command.resolveInclude("nowhere.h", false, includer));
+    EXPECT_FALSE(command.resolveInclude("sub", true, includer)); // a directory
+}
+
+// Test recognizing include directives line by line
+TEST(CompileCommandsTest, ForEachInclude) {
+    auto found = includes(
+        "#include \"a.h\"\n"
+        "  #  include <b/c.h> // comment\n"
+        "#include_next <next.h>\n"
+        "#import \"objc.h\"\n"
+        "#if 0\n#include \"conditional.h\"\n#endif\n"
+        "#include MACRO\n"
+        "#include \"unterminated\n"
+        "int x; #include \"not a directive.h\"\n"
+        "#define include \"d.h\"\n"
+        "\t#include\t\"tab.h\"");
+    std::vector<std::pair<std::string, bool>> expected = {
+        {"a.h", false}, {"b/c.h", true}, {"next.h", true}, {"objc.h", false}, {"conditional.h", false}, {"tab.h", false},
+    };
+    EXPECT_EQ(found, expected);
+    EXPECT_TRUE(includes("").empty());
+    EXPECT_TRUE(includes("#").empty());
+}
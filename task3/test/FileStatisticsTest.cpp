@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "FileStatistics.hpp"
+
+namespace {
+    FileInfo lines(size_t code) {
+        return {.codeLines = code};
+    }
+
+    std::vector<std::string> sortedNames(TopFiles const& top) {
+        std::vector<std::string> names;
+        for (auto const& [path, info] : top.sorted()) names.push_back(path.string() + ":" + std::to_string(info.totalLines()));
+        return names;
+    }
+}
+
+// Test that the top keeps the files with the most lines, ties broken by path
+TEST(TopFilesTest, KeepsLargestFiles) {
+    TopFiles top(3);
+    top.add("c", lines(10));
+    top.add("a", lines(5));
+    top.add("d", lines(10));
+    top.add("b", lines(10));
+    top.add("e", lines(1));
+    EXPECT_EQ(sortedNames(top), (std::vector<std::string>{"b:10", "c:10", "d:10"}));
+    EXPECT_EQ(top.entries().size(), 3u);
+
+    top.add("a", lines(10)); // ranks above b by path
+    top.add("z", lines(11));
+    EXPECT_EQ(sortedNames(top), (std::vector<std::string>{"z:11", "a:10", "b:10"}));
+
+    TopFiles none;
+    none.add("a", lines(1));
+    EXPECT_TRUE(none.entries().empty());
+}
+
+// Test that merging the tops of parts gives the top of the whole, however the files are split
+TEST(TopFilesTest, MergeMatchesWhole) {
+    std::mt19937 random(7);
+    for (int round = 0; round < 200; ++round) {
+        size_t const capacity = 1 + random() % 8;
+        TopFiles whole(capacity);
+        std::vector<TopFiles> parts(1 + random() % 4, TopFiles(capacity));
+        for (int i = 0; i < 40; ++i) {
+            auto path = "f" + std::to_string(random() % 1000);
+            auto info = lines(random() % 5); // many ties
+            whole.add(path, info);
+            parts[random() % parts.size()].add(path, info);
+        }
+
+        TopFiles merged(capacity);
+        for (auto const& part : parts) merged.merge(part);
+        ASSERT_EQ(sortedNames(merged), sortedNames(whole));
+    }
+}
+
+// Test the bucket boundaries of the line histogram
+TEST(LineHistogramTest, Buckets) {
+    for (uint64_t lines = 0; lines < LineHistogram::SUB_BUCKETS; ++lines) {
+        EXPECT_EQ(LineHistogram::bucket(lines), lines);
+        EXPECT_EQ(LineHistogram::lowerBound(lines), lines);
+    }
+    EXPECT_EQ(LineHistogram::bucket(16), 16u);
+    EXPECT_EQ(LineHistogram::bucket(31), 31u);
+    EXPECT_EQ(LineHistogram::bucket(32), 32u);
+    EXPECT_EQ(LineHistogram::bucket(33), 32u);
+    EXPECT_EQ(LineHistogram::bucket(34), 33u);
+    EXPECT_EQ(LineHistogram::lowerBound(33), 34u);
+    EXPECT_EQ(LineHistogram::bucket(~uint64_t{0}), LineHistogram::BUCKETS - 1);
+
+    // every bucket starts where the previous one ends, and holds values within 1/16 of its bound
+    for (size_t bucket = 1; bucket < LineHistogram::BUCKETS; ++bucket) {
+        auto lower = LineHistogram::lowerBound(bucket);
+        ASSERT_GT(lower, LineHistogram::lowerBound(bucket - 1));
+        ASSERT_EQ(LineHistogram::bucket(lower), bucket);
+        ASSERT_EQ(LineHistogram::bucket(lower - 1), bucket - 1);
+        ASSERT_LE(lower - LineHistogram::lowerBound(bucket - 1), std::max<uint64_t>(1, lower / LineHistogram::SUB_BUCKETS));
+    }
+}
+
+// Test the quantiles read from the line histogram
+TEST(LineHistogramTest, Quantiles) {
+    LineHistogram histogram;
+    EXPECT_EQ(histogram.quantile(0.5), 0u);
+
+    for (uint64_t lines = 1; lines <= 100; ++lines) histogram.add(lines);
+    EXPECT_EQ(histogram.count(), 100u);
+    EXPECT_EQ(histogram.max, 100u);
+    EXPECT_EQ(histogram.quantile(0), 1u);
+    EXPECT_EQ(histogram.quantile(0.1), 10u);
+    EXPECT_EQ(histogram.quantile(0.5), 50u);
+    EXPECT_EQ(histogram.quantile(0.9), 88u); // 90 shares a bucket with 88 and 89
+    EXPECT_EQ(histogram.quantile(1), 100u);
+    EXPECT_EQ(histogram.quantile(2), 100u);
+
+    LineHistogram other;
+    other.add(100000);
+    histogram.merge(other);
+    EXPECT_EQ(histogram.count(), 101u);
+    EXPECT_EQ(histogram.max, 100000u);
+    EXPECT_EQ(histogram.quantile(1), 98304u);
+
+    LineHistogram single;
+    single.add(1000);
+    EXPECT_EQ(single.quantile(1), 992u);
+    EXPECT_LE(1000 - single.quantile(0.5), 1000 / LineHistogram::SUB_BUCKETS);
+}
+
+// Test the comment ratio percentiles
+TEST(RatioHistogramTest, Quantiles) {
+    RatioHistogram histogram;
+    histogram.add({.blankLines = 10});                       // no comment or code, not counted
+    histogram.add({.commentLines = 1, .codeLines = 3});      // 25%
+    histogram.add({.commentLines = 2, .codeLines = 1});      // 66%
+    histogram.add({.blankLines = 5, .commentLines = 4});     // 100%, counted as 99%
+    histogram.add({.codeLines = 7});                         // 0%
+    EXPECT_EQ(histogram.count(), 4u);
+    EXPECT_EQ(histogram.quantile(0), 0u);
+    EXPECT_EQ(histogram.quantile(0.5), 25u);
+    EXPECT_EQ(histogram.quantile(0.75), 66u);
+    EXPECT_EQ(histogram.quantile(1), 99u);
+
+    RatioHistogram other;
+    other.add({.commentLines = 1, .codeLines = 1});
+    histogram.merge(other);
+    EXPECT_EQ(histogram.count(), 5u);
+    EXPECT_EQ(histogram.quantile(0.6), 50u);
+}
@@ -0,0 +1,179 @@
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "ScanResult.hpp"
+#include "TempDir.hpp"
+
+namespace {
+    FileInfo info(size_t blank, size_t comment, size_t code) {
+        return {blank, comment, code};
+    }
+
+    void expectSameInfo(FileInfo const& a, FileInfo const& b) {
+        EXPECT_EQ(a.blankLines, b.blankLines);
+        EXPECT_EQ(a.commentLines, b.commentLines);
+        EXPECT_EQ(a.codeLines, b.codeLines);
+    }
+
+    void expectSameResult(ScanResult const& a, ScanResult const& b) {
+        EXPECT_EQ(a.totalFiles, b.totalFiles);
+        expectSameInfo(a.total, b.total);
+        ASSERT_EQ(a.types.size(), b.types.size());
+        for (auto const& [type, stats] : a.types) {
+            ASSERT_TRUE(b.types.contains(type));
+            EXPECT_EQ(stats.fileCount, b.types.at(type).fileCount);
+            expectSameInfo(stats.info, b.types.at(type).info);
+        }
+        ASSERT_EQ(a.files.size(), b.files.size());
+        for (auto const& [path, fileInfo] : a.files) {
+            ASSERT_TRUE(b.files.contains(path)) << path;
+            expectSameInfo(fileInfo, b.files.at(path));
+        }
+        EXPECT_EQ(a.top.capacity(), b.top.capacity());
+        auto topA = a.top.sorted();
+        auto topB = b.top.sorted();
+        ASSERT_EQ(topA.size(), topB.size());
+        for (size_t i = 0; i < topA.size(); ++i) {
+            EXPECT_EQ(topA[i].first, topB[i].first);
+            expectSameInfo(topA[i].second, topB[i].second);
+        }
+        EXPECT_EQ(a.linesPerFile.counts, b.linesPerFile.counts);
+        EXPECT_EQ(a.linesPerFile.max, b.linesPerFile.max);
+        EXPECT_EQ(a.commentRatio.counts, b.commentRatio.counts);
+    }
+
+    ScanResult sampleResult(bool keepFiles, size_t topCapacity) {
+        ScanResult result;
+        result.top = TopFiles(topCapacity);
+        result.add("src/a.cpp", FileType::Cpp, info(3, 4, 50), keepFiles);
+        result.add("src/a.hpp", FileType::CppHeader, info(1, 10, 5), keepFiles);
+        result.add("src/b.c", FileType::C, info(0, 0, 7), keepFiles);
+        result.add("src/dir with spaces/c.cpp", FileType::Cpp, info(100, 0, 0), keepFiles);
+        return result;
+    }
+
+    std::string readFile(std::filesystem::path const& path) {
+        std::ifstream file(path, std::ios::binary);
+        return {std::istreambuf_iterator<char>(file), {}};
+    }
+}
+
+// Test writing and reading back partial results, with and without per-file records and top files
+TEST(ScanResultTest, RoundTrip) {
+    TempDir dir;
+    for (bool keepFiles : {false, true}) {
+        for (size_t topCapacity : {0, 2, 10}) {
+            auto result = sampleResult(keepFiles, topCapacity);
+            auto path = dir.path() / "partial.bin";
+            ASSERT_TRUE(writeScanResult(path, result));
+            auto read = readScanResult(path);
+            ASSERT_TRUE(read);
+            expectSameResult(result, *read);
+        }
+    }
+
+    ScanResult empty;
+    auto path = dir.path() / "empty.bin";
+    ASSERT_TRUE(writeScanResult(path, empty));
+    auto read = readScanResult(path);
+    ASSERT_TRUE(read);
+    expectSameResult(empty, *read);
+}
+
+// Test that truncated, extended and foreign files are rejected
+TEST(ScanResultTest, MalformedFiles) {
+    TempDir dir;
+    auto path = dir.path() / "partial.bin";
+    ASSERT_TRUE(writeScanResult(path, sampleResult(true, 3)));
+    auto contents = readFile(path);
+
+    for (size_t size = 0; size < contents.size(); size += 7) {
+        EXPECT_FALSE(readScanResult(dir.write("cut.bin", std::string_view(contents).substr(0, size)))) << size;
+    }
+    EXPECT_FALSE(readScanResult(dir.write("longer.bin", contents + '\0')));
+
+    auto version = contents;
+    version[6] = '\x01';
+    EXPECT_FALSE(readScanResult(dir.write("version.bin", version)));
+    EXPECT_FALSE(readScanResult(dir.path() / "missing.bin"));
+    EXPECT_FALSE(readScanResult(dir.path()));
+}
+
+// Test that merging partial results gives the result of one scan
+TEST(ScanResultTest, Merge) {
+    ScanResult whole;
+    whole.top = TopFiles(2);
+    ScanResult first;
+    first.top = TopFiles(2);
+    ScanResult second;
+    second.top = TopFiles(2);
+    std::vector<std::pair<std::filesystem::path, FileInfo>> files = {
+        {"a.cpp", info(1, 2, 3)}, {"b.cpp", info(0, 0, 10)}, {"c.h", info(5, 5, 5)}, {"d.c", info(0, 1, 0)},
+    };
+    for (size_t i = 0; i < files.size(); ++i) {
+        auto type = getFileType(files[i].first);
+        whole.add(files[i].first, type, files[i].second, false);
+        (i % 2 == 0 ? first : second).add(files[i].first, type, files[i].second, false);
+    }
+
+    ScanResult merged;
+    merged.top = TopFiles(2);
+    merged.merge(first);
+    merged.merge(second);
+    expectSameResult(whole, merged);
+}
+
+// Test when a partial result can report the top files
+TEST(ScanResultTest, HasTop) {
+    EXPECT_TRUE(sampleResult(false, 10).hasTop(10));
+    EXPECT_FALSE(sampleResult(false, 2).hasTop(10));
+    EXPECT_TRUE(sampleResult(false, 2).hasTop(2));
+    EXPECT_TRUE(sampleResult(true, 0).hasTop(10));  // per-file records hold every file
+    EXPECT_TRUE(sampleResult(false, 4).hasTop(10)); // every file made it into the top
+
+    // per-file records rebuild a top shorter than the one merged into
+    ScanResult merged;
+    merged.top = TopFiles(3);
+    merged.merge(sampleResult(true, 0));
+    std::vector<std::filesystem::path> top;
+    for (auto const& [path, _] : merged.top.sorted()) top.push_back(path);
+    EXPECT_EQ(top, (std::vector<std::filesystem::path>{"src/dir with spaces/c.cpp", "src/a.cpp", "src/a.hpp"}));
+}
+
+// Test parsing shard specifications
+TEST(ShardTest, Parse) {
+    auto shard = Shard::parse("2/5");
+    ASSERT_TRUE(shard);
+    EXPECT_EQ(shard->index, 2u);
+    EXPECT_EQ(shard->count, 5u);
+    EXPECT_TRUE(Shard::parse("0/1"));
+
+    for (std::string_view text : {"", "1", "5/5", "6/5", "0/0", "-1/2", "1/2/3", "a/2", "1/b", " 1/2", "1/2 ", "/2", "1/"}) {
+        EXPECT_FALSE(Shard::parse(text)) << text;
+    }
+}
+
+// Test that the shards of a count split the files between them, each file in exactly one
+TEST(ShardTest, Contains) {
+    std::vector<std::filesystem::path> paths;
+    for (int i = 0; i < 1000; ++i) paths.push_back("src/module" + std::to_string(i % 37) + "/file" + std::to_string(i) + ".cpp");
+
+    EXPECT_TRUE(Shard{}.contains("anything"));
+    for (size_t count : {2, 3, 8}) {
+        std::vector<size_t> sizes(count);
+        for (auto const& path : paths) {
+            size_t owners = 0;
+            for (size_t index = 0; index < count; ++index) {
+                if (Shard{index, count}.contains(path)) {
+                    ++owners;
+                    ++sizes[index];
+                }
+            }
+            ASSERT_EQ(owners, 1u) << path;
+        }
+        // roughly even
+        for (auto size : sizes) EXPECT_GT(size, paths.size() / count / 2) << count;
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <string_view>
+
+// A fresh directory under the system temporary directory, removed with everything in it.
+class TempDir {
+public:
+    TempDir() {
+        std::random_device random;
+        do {
+            m_path = std::filesystem::temp_directory_path() / ("task3_test_" + std::to_string(random()));
+        } while (!std::filesystem::create_directory(m_path));
+    }
+
+    TempDir(TempDir const&) = delete;
+    TempDir& operator=(TempDir const&) = delete;
+
+    ~TempDir() {
+        std::error_code ec;
+        std::filesystem::remove_all(m_path, ec);
+    }
+
+    [[nodiscard]] std::filesystem::path const& path() const { return m_path; }
+
+    // writes contents to name, relative to the directory, creating the directories in between
+    std::filesystem::path write(std::filesystem::path const& name, std::string_view contents) const {
+        auto file = m_path / name;
+        std::filesystem::create_directories(file.parent_path());
+        std::ofstream(file, std::ios::binary).write(contents.data(), static_cast<std::streamsize>(contents.size()));
+        return file;
+    }
+
+private:
+    std::filesystem::path m_path;
+};